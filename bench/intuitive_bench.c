@@ -0,0 +1,460 @@
+/**
+ * intuitive_bench - Frame pipeline benchmark
+ *
+ * Builds synthetic trees of a given shape and runs them through tui_run()
+ * on the headless terminal, one scripted key press per frame. For every
+ * rendered frame the time spent building, measuring, positioning, moving
+ * focus, diffing, rendering and flushing is read from the frame
+ * statistics, together with the bytes sent and the heap allocations made.
+ *
+ * Usage:
+ *   intuitive_bench [--frames N] [--warmup N] [--screen WxH] [scenario[=size] ...]
+ *
+ * Scenarios (size in parentheses, default after it):
+ *   deep_vstack  VStacks nested inside each other (depth, 1000)
+ *   wide_hstack  One HStack of Text children (children, 1000)
+ *   list         List with an item provider, paging down (items, 100000)
+ *   table        Table with a row provider, paging down (rows, 10000)
+ *   spinners     Rows of animating Spinners (spinners, 200)
+ *
+ * Without scenarios, all of them run at their default size. Each one
+ * prints a JSON object on a line of its own, with per-frame averages, so
+ * results can be collected and compared across commits.
+ */
+
+#include "intuitive.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_FRAMES 200
+#define DEFAULT_WARMUP 10
+#define DEFAULT_WIDTH 120
+#define DEFAULT_HEIGHT 40
+
+// Virtual time between key presses: a 60 Hz frame
+#define KEY_INTERVAL_MS 16
+
+#define KEY_DOWN_SEQUENCE "\033[B"
+
+// List animates a scroll over 150 ms, restarting from where the animation
+// stands whenever the offset changes again. Scrolling on every key would
+// restart it before it moves, so list and table page down once this often
+#define SCROLL_INTERVAL_FRAMES 10
+
+#define SPINNERS_PER_ROW 8
+#define TABLE_COLUMNS 4
+
+/* ========== Allocation counting ========== */
+
+// The library allocates with malloc/calloc/realloc; the build wraps them
+// at link time (see CMakeLists.txt) where the linker supports it
+static unsigned long alloc_count = 0;
+static unsigned long alloc_bytes = 0;
+
+#ifdef INTUITIVE_BENCH_WRAP_MALLOC
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void* __wrap_malloc(size_t size);
+void* __wrap_calloc(size_t count, size_t size);
+void* __wrap_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+    alloc_count++;
+    alloc_bytes += size;
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    alloc_count++;
+    alloc_bytes += count * size;
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    alloc_count++;
+    alloc_bytes += size;
+    return __real_realloc(ptr, size);
+}
+#endif
+
+/* ========== Scenarios ========== */
+
+typedef struct {
+    const char* name;
+    int default_size;
+    bool (*setup)(void);
+    component_t* (*build)(void);
+    void (*teardown)(void);
+} scenario_t;
+
+// State of the scenario being run
+static struct {
+    int size;
+    int frame;                // Calls to the root function so far
+    char label[32];           // Changes every frame
+    component_t** children;   // Scratch arrays for the stacks, reused every frame
+    component_t** rows;
+    int scroll_offset;
+    int selected;
+} state;
+
+static bool setup_nothing(void) {
+    return true;
+}
+
+static void teardown_arrays(void) {
+    free(state.children);
+    free(state.rows);
+    state.children = NULL;
+    state.rows = NULL;
+}
+
+// deep_vstack: the counter sits in the innermost stack, on the first row
+
+static component_t* build_deep_vstack(void) {
+    component_t* node = Text(state.label, TEXT_DEFAULT);
+    for (int i = 0; i < state.size; i++) {
+        node = VStack(node, Text("level", (TextConfig){ .borrow = true }), NULL);
+    }
+    return node;
+}
+
+// wide_hstack: the counter is the first child
+
+static bool setup_wide_hstack(void) {
+    state.children = malloc(((size_t)state.size + 1) * sizeof(component_t*));
+    return state.children != NULL;
+}
+
+static component_t* build_wide_hstack(void) {
+    state.children[0] = Text(state.label, TEXT_DEFAULT);
+    for (int i = 1; i < state.size; i++) {
+        state.children[i] = Text("cell", (TextConfig){ .borrow = true });
+    }
+    state.children[state.size] = NULL;
+    return AlignedHStack((StackConfig){ .children = state.children, .spacing = 1 });
+}
+
+// list: pages through the items, selecting the first visible one
+
+/**
+ * Page down every SCROLL_INTERVAL_FRAMES frames, wrapping around at the end
+ * The keys move the selection too, but it's reset on every frame
+ */
+static void scroll_pages(int page_size) {
+    state.scroll_offset = (int)((long)(state.frame / SCROLL_INTERVAL_FRAMES) * page_size % state.size);
+    state.selected = state.scroll_offset;
+}
+
+static const char* list_item(int index, void* ctx) {
+    static char item[48];
+    (void)ctx;
+    snprintf(item, sizeof(item), "Item %d: %s", index, index % 3 ? "regular" : "highlighted");
+    return item;
+}
+
+static component_t* build_list(void) {
+    int width, height;
+    tui_get_terminal_size(&width, &height);
+    scroll_pages(height - 1);
+    return VStack(
+        Text(state.label, TEXT_DEFAULT),
+        List((ListConfig){
+            .item_provider = list_item,
+            .count = state.size,
+            .item_width = 32,
+            .max_visible = height - 1,
+            .scroll_offset = &state.scroll_offset,
+            .selected_index = &state.selected,
+        }),
+        NULL
+    );
+}
+
+// table: as list, with a bordered table of fixed-width columns
+
+static const char** table_row(int row, void* ctx) {
+    static char id[16];
+    static char name[32];
+    static char size[16];
+    static const char* cells[TABLE_COLUMNS];
+    (void)ctx;
+    snprintf(id, sizeof(id), "%d", row);
+    snprintf(name, sizeof(name), "process-%d", row * 7919 % 100000);
+    snprintf(size, sizeof(size), "%d KB", row * 37 % 65536);
+    cells[0] = id;
+    cells[1] = name;
+    cells[2] = size;
+    cells[3] = row % 5 ? "running" : "sleeping";
+    return cells;
+}
+
+static component_t* build_table(void) {
+    static const char* headers[TABLE_COLUMNS] = { "PID", "Name", "Memory", "State" };
+    static const int widths[TABLE_COLUMNS] = { 8, 20, 10, 10 };
+    int width, height;
+    tui_get_terminal_size(&width, &height);
+    scroll_pages(height - 5);
+    return VStack(
+        Text(state.label, TEXT_DEFAULT),
+        Table((TableConfig){
+            .headers = headers,
+            .column_count = TABLE_COLUMNS,
+            .row_provider = table_row,
+            .row_count = state.size,
+            .column_widths = widths,
+            .show_borders = true,
+            .max_visible = height - 5,
+            .scroll_offset = &state.scroll_offset,
+            .selected_row = &state.selected,
+        }),
+        NULL
+    );
+}
+
+// spinners: SPINNERS_PER_ROW to an HStack, advancing with the virtual clock
+
+static bool setup_spinners(void) {
+    int row_count = (state.size + SPINNERS_PER_ROW - 1) / SPINNERS_PER_ROW;
+    state.rows = malloc(((size_t)row_count + 1) * sizeof(component_t*));
+    state.children = malloc((size_t)row_count * (SPINNERS_PER_ROW + 1) * sizeof(component_t*));
+    return state.rows && state.children;
+}
+
+static component_t* build_spinners(void) {
+    int row_count = (state.size + SPINNERS_PER_ROW - 1) / SPINNERS_PER_ROW;
+    for (int row = 0; row < row_count; row++) {
+        component_t** children = &state.children[row * (SPINNERS_PER_ROW + 1)];
+        int count = 0;
+        for (int i = row * SPINNERS_PER_ROW; i < state.size && count < SPINNERS_PER_ROW; i++) {
+            children[count++] = Spinner((SpinnerConfig){
+                .style = (spinner_style_t)(i % 5),
+                .speed = 80,
+                .text = "busy",
+            });
+        }
+        children[count] = NULL;
+        state.rows[row] = AlignedHStack((StackConfig){ .children = children, .spacing = 2 });
+    }
+    state.rows[row_count] = NULL;
+    return VStack(Text(state.label, TEXT_DEFAULT), VStackArray(state.rows), NULL);
+}
+
+static const scenario_t scenarios[] = {
+    { "deep_vstack", 1000, setup_nothing, build_deep_vstack, teardown_arrays },
+    { "wide_hstack", 1000, setup_wide_hstack, build_wide_hstack, teardown_arrays },
+    { "list", 100000, setup_nothing, build_list, teardown_arrays },
+    { "table", 10000, setup_nothing, build_table, teardown_arrays },
+    { "spinners", 200, setup_spinners, build_spinners, teardown_arrays },
+};
+
+#define SCENARIO_COUNT ((int)(sizeof(scenarios) / sizeof(scenarios[0])))
+
+/* ========== Measurement ========== */
+
+// Totals over the measured frames
+typedef struct {
+    unsigned long frames;
+    uint64_t build_ns;
+    uint64_t measure_ns;
+    uint64_t position_ns;
+    uint64_t focus_ns;
+    uint64_t diff_ns;
+    uint64_t render_ns;
+    uint64_t flush_ns;
+    unsigned long bytes;
+    unsigned long syscalls;
+    unsigned long allocs;
+    unsigned long alloc_bytes;
+} totals_t;
+
+static const scenario_t* current_scenario = NULL;
+static int warmup_frames = DEFAULT_WARMUP;
+static unsigned long measured_frames;   // Frames to measure after the warmup
+static totals_t totals;
+static unsigned long frames_seen;      // Rendered frames of this scenario
+static unsigned long last_frame;       // Frame number of the last sample
+static unsigned long alloc_count_mark; // Allocation counters at the last sample
+static unsigned long alloc_bytes_mark;
+
+/**
+ * Add the frame rendered since the last sample, if any, to the totals
+ * Allocations are charged to the frame they were made after, which
+ * includes handling the input that led to the next one. Frames past the
+ * requested count, such as the one rendered for the last key, are left out
+ */
+static void sample_frame(void) {
+    tui_frame_stats_t stats;
+    if (!tui_get_frame_stats(&stats) || stats.frame == last_frame) {
+        return;
+    }
+    last_frame = stats.frame;
+
+    unsigned long allocs = alloc_count - alloc_count_mark;
+    unsigned long bytes = alloc_bytes - alloc_bytes_mark;
+    alloc_count_mark = alloc_count;
+    alloc_bytes_mark = alloc_bytes;
+
+    // The first frames paint the whole screen and fill the caches
+    if (frames_seen++ < (unsigned long)warmup_frames || totals.frames == measured_frames) {
+        return;
+    }
+
+    totals.frames++;
+    totals.build_ns += stats.build_ns;
+    totals.measure_ns += stats.measure_ns;
+    totals.position_ns += stats.position_ns;
+    totals.focus_ns += stats.focus_ns;
+    totals.diff_ns += stats.diff_ns;
+    totals.render_ns += stats.render_ns;
+    totals.flush_ns += stats.flush_ns;
+    totals.bytes += stats.bytes;
+    totals.syscalls += stats.syscalls;
+    totals.allocs += allocs;
+    totals.alloc_bytes += bytes;
+}
+
+static component_t* bench_root(void) {
+    sample_frame();
+    snprintf(state.label, sizeof(state.label), "frame %d", state.frame++);
+    return current_scenario->build();
+}
+
+static double per_frame(double total) {
+    return totals.frames ? total / (double)totals.frames : 0.0;
+}
+
+static void print_result(const scenario_t* scenario, int width, int height) {
+    uint64_t total_ns = totals.build_ns + totals.measure_ns + totals.position_ns +
+                        totals.focus_ns + totals.diff_ns + totals.render_ns + totals.flush_ns;
+
+    printf("{\"scenario\":\"%s\",\"size\":%d,\"width\":%d,\"height\":%d,\"frames\":%lu,",
+           scenario->name, state.size, width, height, totals.frames);
+    printf("\"ns_per_frame\":{\"build\":%.0f,\"measure\":%.0f,\"position\":%.0f,"
+           "\"focus\":%.0f,\"diff\":%.0f,\"render\":%.0f,\"flush\":%.0f,\"total\":%.0f},",
+           per_frame((double)totals.build_ns), per_frame((double)totals.measure_ns),
+           per_frame((double)totals.position_ns), per_frame((double)totals.focus_ns),
+           per_frame((double)totals.diff_ns), per_frame((double)totals.render_ns),
+           per_frame((double)totals.flush_ns), per_frame((double)total_ns));
+#ifdef INTUITIVE_BENCH_WRAP_MALLOC
+    printf("\"allocs_per_frame\":%.2f,\"alloc_bytes_per_frame\":%.0f,",
+           per_frame((double)totals.allocs), per_frame((double)totals.alloc_bytes));
+#else
+    printf("\"allocs_per_frame\":null,\"alloc_bytes_per_frame\":null,");
+#endif
+    printf("\"bytes_per_frame\":%.1f,\"syscalls_per_frame\":%.2f}\n",
+           per_frame((double)totals.bytes), per_frame((double)totals.syscalls));
+    fflush(stdout);
+}
+
+static bool run_scenario(const scenario_t* scenario, int size, int frames, int width, int height) {
+    memset(&state, 0, sizeof(state));
+    memset(&totals, 0, sizeof(totals));
+    state.size = size;
+    current_scenario = scenario;
+    frames_seen = 0;
+    measured_frames = (unsigned long)frames;
+
+    if (!scenario->setup()) {
+        fprintf(stderr, "intuitive_bench: %s: out of memory\n", scenario->name);
+        return false;
+    }
+
+    if (!tui_use_headless(width, height)) {
+        fprintf(stderr, "intuitive_bench: can't create a %dx%d terminal\n", width, height);
+        scenario->teardown();
+        return false;
+    }
+
+    // One key per frame; 'q' ends the run even while spinners animate
+    for (int i = 0; i < warmup_frames + frames; i++) {
+        tui_headless_input(KEY_INTERVAL_MS, KEY_DOWN_SEQUENCE, strlen(KEY_DOWN_SEQUENCE));
+    }
+    tui_headless_input(KEY_INTERVAL_MS, "q", 1);
+
+    alloc_count_mark = alloc_count;
+    alloc_bytes_mark = alloc_bytes;
+
+    tui_init();
+    tui_set_root(bench_root);
+    tui_run();
+    sample_frame();
+
+    print_result(scenario, width, height);
+    scenario->teardown();
+    return true;
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: intuitive_bench [--frames N] [--warmup N] [--screen WxH] [scenario[=size] ...]\n");
+    fprintf(stderr, "scenarios:");
+    for (int i = 0; i < SCENARIO_COUNT; i++) {
+        fprintf(stderr, " %s", scenarios[i].name);
+    }
+    fprintf(stderr, "\n");
+}
+
+static const scenario_t* find_scenario(const char* name, size_t length) {
+    for (int i = 0; i < SCENARIO_COUNT; i++) {
+        if (strlen(scenarios[i].name) == length && strncmp(scenarios[i].name, name, length) == 0) {
+            return &scenarios[i];
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char** argv) {
+    int frames = DEFAULT_FRAMES;
+    int width = DEFAULT_WIDTH;
+    int height = DEFAULT_HEIGHT;
+
+    int first_scenario = argc;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            warmup_frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--screen") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &width, &height) != 2) {
+                usage();
+                return 2;
+            }
+        } else if (argv[i][0] == '-') {
+            usage();
+            return 2;
+        } else {
+            first_scenario = i;
+            break;
+        }
+    }
+    if (frames <= 0 || warmup_frames < 0 || width <= 0 || height <= 5) {
+        usage();
+        return 2;
+    }
+
+    if (first_scenario == argc) {
+        for (int i = 0; i < SCENARIO_COUNT; i++) {
+            if (!run_scenario(&scenarios[i], scenarios[i].default_size, frames, width, height)) {
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    for (int i = first_scenario; i < argc; i++) {
+        const char* equals = strchr(argv[i], '=');
+        size_t name_length = equals ? (size_t)(equals - argv[i]) : strlen(argv[i]);
+        const scenario_t* scenario = find_scenario(argv[i], name_length);
+        int size = scenario && equals ? atoi(equals + 1) : (scenario ? scenario->default_size : 0);
+        if (!scenario || size <= 0) {
+            usage();
+            return 2;
+        }
+        if (!run_scenario(scenario, size, frames, width, height)) {
+            return 1;
+        }
+    }
+    return 0;
+}
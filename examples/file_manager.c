@@ -206,7 +206,8 @@ static component_t* app(void) {
             .max_visible = max_visible,
             .scroll_offset = &state.list_scroll,
             .selected_index = &state.selected_index,
-            .on_select = on_select_file
+            .on_select = on_select_file,
+            .borrow = true  // file_list is only rebuilt between frames
         });
     } else {
         items[idx++] = Text("(empty directory)", (TextConfig){
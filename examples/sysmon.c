@@ -17,6 +17,20 @@ typedef struct {
     char user[32];
 } process_info_t;
 
+/**
+ * One round of stats, collected by the update thread and handed to the
+ * UI thread with tui_post()
+ */
+typedef struct {
+    float cpu_usage;
+    float mem_usage;
+    long mem_used;
+    int process_count_total;
+    process_info_t processes[MAX_PROCESSES];
+    int process_count;
+    time_t collected_at;
+} stats_t;
+
 typedef struct {
     // System stats
     float cpu_usage;
@@ -51,8 +65,8 @@ static app_state_t state = {
     .status_message = "Initializing..."
 };
 
-// Mutex to protect state access between threads
-static pthread_mutex_t state_mutex = PTHREAD_MUTEX_INITIALIZER;
+// state is only touched on the UI thread; the update thread posts stats_t
+// snapshots instead of writing to it
 static pthread_t update_thread;
 static bool thread_running = false;
 
@@ -89,7 +103,7 @@ static float read_cpu_usage(void) {
 /**
  * Read memory usage from system (macOS)
  */
-static void read_memory_usage(void) {
+static void read_memory_usage(stats_t* stats) {
     // Get used memory (active + wired pages)
     FILE* fp = popen("vm_stat | grep -E 'Pages active|Pages wired' | awk '{print $3}' | tr -d '.'", "r");
     if (!fp) return;
@@ -99,34 +113,34 @@ static void read_memory_usage(void) {
     if (fscanf(fp, "%ld", &wired) != 1) wired = 0;
     pclose(fp);
 
-    // Pages are 4KB on macOS
-    state.mem_used = (active + wired) * 4096;
+    // Pages are 4KB on macOS (mem_total is only written before the thread starts)
+    stats->mem_used = (active + wired) * 4096;
     if (state.mem_total > 0) {
-        state.mem_usage = (state.mem_used * 100.0) / state.mem_total;
+        stats->mem_usage = (stats->mem_used * 100.0) / state.mem_total;
     }
 }
 
 /**
  * Read process list from system
  */
-static void read_processes(void) {
+static void read_processes(stats_t* stats) {
     // Get total process count
     FILE* fp = popen("ps aux | wc -l", "r");
     if (fp) {
-        fscanf(fp, "%d", &state.process_count_total);
+        fscanf(fp, "%d", &stats->process_count_total);
         pclose(fp);
-        state.process_count_total--; // Subtract header line
+        stats->process_count_total--; // Subtract header line
     }
 
     // Get top processes by CPU
     fp = popen("ps aux | tail -n +2 | sort -rn -k 3 | head -50", "r");
     if (!fp) return;
 
-    state.process_count = 0;
+    stats->process_count = 0;
     char line[512];
 
-    while (fgets(line, sizeof(line), fp) && state.process_count < MAX_PROCESSES) {
-        process_info_t* proc = &state.processes[state.process_count];
+    while (fgets(line, sizeof(line), fp) && stats->process_count < MAX_PROCESSES) {
+        process_info_t* proc = &stats->processes[stats->process_count];
 
         // Parse: USER PID %CPU %MEM ... COMMAND
         char command[256];
@@ -144,13 +158,35 @@ static void read_processes(void) {
             strncpy(proc->name, name, MAX_PROCESS_NAME - 1);
             proc->name[MAX_PROCESS_NAME - 1] = '\0';
 
-            state.process_count++;
+            stats->process_count++;
         }
     }
 
     pclose(fp);
 }
 
+/**
+ * Apply a stats snapshot (runs on the UI thread via tui_post)
+ */
+static void apply_stats(void* ctx) {
+    stats_t* stats = (stats_t*)ctx;
+
+    state.cpu_usage = stats->cpu_usage;
+    state.mem_usage = stats->mem_usage;
+    state.mem_used = stats->mem_used;
+    state.process_count_total = stats->process_count_total;
+    memcpy(state.processes, stats->processes, sizeof(state.processes));
+    state.process_count = stats->process_count;
+
+    state.last_update = stats->collected_at;
+    snprintf(state.status_message, sizeof(state.status_message),
+             "Updated at %s", ctime(&stats->collected_at));
+    // Remove newline from ctime
+    state.status_message[strlen(state.status_message) - 1] = '\0';
+
+    free(stats);
+}
+
 /**
  * Background thread function to update system stats
  */
@@ -159,26 +195,18 @@ static void* update_thread_func(void* arg) {
 
     while (thread_running) {
         // Collect stats (this is slow, but happens in background)
-        float cpu = read_cpu_usage();
-
-        // Lock mutex before updating shared state
-        pthread_mutex_lock(&state_mutex);
-
-        state.cpu_usage = cpu;
-        read_memory_usage();
-        read_processes();
-
-        time_t now = time(NULL);
-        state.last_update = now;
-        snprintf(state.status_message, sizeof(state.status_message),
-                 "Updated at %s", ctime(&now));
-        // Remove newline from ctime
-        state.status_message[strlen(state.status_message) - 1] = '\0';
-
-        pthread_mutex_unlock(&state_mutex);
-
-        // Request UI re-render
-        tui_request_render();
+        stats_t* stats = calloc(1, sizeof(stats_t));
+        if (stats) {
+            stats->cpu_usage = read_cpu_usage();
+            read_memory_usage(stats);
+            read_processes(stats);
+            stats->collected_at = time(NULL);
+
+            // Hand the snapshot to the UI thread, which wakes up and re-renders
+            if (!tui_post(apply_stats, stats)) {
+                free(stats);
+            }
+        }
 
         // Sleep for update interval
         sleep(state.update_interval);
@@ -259,28 +287,17 @@ static component_t* app(void) {
     int term_width, term_height;
     tui_get_terminal_size(&term_width, &term_height);
 
-    // Copy state with mutex lock (minimize lock time)
-    pthread_mutex_lock(&state_mutex);
-
+    // State is only updated on this thread (see apply_stats), so no locking
     float cpu_usage = state.cpu_usage;
     float mem_usage = state.mem_usage;
     long mem_total = state.mem_total;
     long mem_used = state.mem_used;
     int process_count_total = state.process_count_total;
     int process_count = state.process_count;
-    char status_message[128];
-    strncpy(status_message, state.status_message, sizeof(status_message) - 1);
-    status_message[sizeof(status_message) - 1] = '\0';
+    const char* status_message = state.status_message;
+    const process_info_t* processes = state.processes;
 
-    // Copy process list
-    process_info_t processes[MAX_PROCESSES];
-    for (int i = 0; i < state.process_count; i++) {
-        processes[i] = state.processes[i];
-    }
-
-    pthread_mutex_unlock(&state_mutex);
-
-    // Format stats (outside mutex)
+    // Format stats
     char cpu_str[64];
     char mem_str[64];
     char mem_total_str[32];
@@ -300,7 +317,7 @@ static component_t* app(void) {
     static char process_lines[MAX_PROCESSES][128];
 
     for (int i = 0; i < process_count; i++) {
-        process_info_t* proc = &processes[i];
+        const process_info_t* proc = &processes[i];
         snprintf(process_lines[i], sizeof(process_lines[i]),
                  "%-6d  %5.1f%%  %5.1f%%  %-12s  %s",
                  proc->pid, proc->cpu, proc->mem, proc->user, proc->name);
@@ -411,10 +428,11 @@ int main(void) {
     // Initialize system info
     init_system_info();
 
-    // Start background update thread
+    tui_init();
+
+    // Start background update thread once tui_post() can accept its updates
     start_update_thread();
 
-    tui_init();
     tui_set_root(app);
     tui_run();
 
@@ -71,28 +71,32 @@ static component_t* app(void) {
             .message = "File saved successfully!",
             .is_visible = &state.show_toast_bottom,
             .position = TOAST_BOTTOM,
-            .on_close = close_toast
+            .on_close = close_toast,
+            .duration_ms = 2000
         }),
 
         Toast((ToastConfig){
             .message = "Task completed!",
             .is_visible = &state.show_toast_top,
             .position = TOAST_TOP,
-            .on_close = close_toast
+            .on_close = close_toast,
+            .duration_ms = 2000
         }),
 
         Toast((ToastConfig){
             .message = "New message received",
             .is_visible = &state.show_toast_top_right,
             .position = TOAST_TOP_RIGHT,
-            .on_close = close_toast
+            .on_close = close_toast,
+            .duration_ms = 2000
         }),
 
         Toast((ToastConfig){
             .message = "Download complete!",
             .is_visible = &state.show_toast_bottom_right,
             .position = TOAST_BOTTOM_RIGHT,
-            .on_close = close_toast
+            .on_close = close_toast,
+            .duration_ms = 2000
         }),
 
         NULL
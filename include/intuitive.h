@@ -2,6 +2,7 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -111,10 +112,55 @@ void tui_run(void);
 
 /**
  * Request a re-render on the next event loop iteration
- * Call this after modifying application state
+ * Call this after modifying application state. The event loop sleeps until
+ * input arrives or a render is requested, so state changed outside of input
+ * handlers (e.g. by a background thread) is only shown after calling this.
+ * Wakes the event loop when called from another thread.
  */
 void tui_request_render(void);
 
+/**
+ * Run fn(ctx) on the UI thread
+ * Safe to call from any thread. The event loop wakes up, calls fn before
+ * building the next frame and then re-renders, so fn can update application
+ * state without locking. Callbacks run in the order they were posted;
+ * those still queued when tui_run() returns are run before it returns.
+ * Returns false before tui_init(), once tui_run() has returned, or when
+ * too many callbacks are queued; fn is then not called and the caller
+ * keeps ownership of ctx.
+ */
+bool tui_post(void (*fn)(void* ctx), void* ctx);
+
+/**
+ * Call fn(ctx) once, delay_ms from now
+ * Timers run on the UI thread (only call these from it) and the frame
+ * after a timer fires is re-rendered. The event loop sleeps until the
+ * next timer is due, so timers cost nothing while waiting.
+ * Returns a timer id for tui_cancel_timer(), or 0 on failure
+ */
+int tui_set_timeout(int delay_ms, void (*fn)(void* ctx), void* ctx);
+
+/**
+ * Call fn(ctx) every interval_ms until cancelled
+ * Missed intervals are skipped rather than fired back to back.
+ * Returns a timer id for tui_cancel_timer(), or 0 on failure
+ */
+int tui_set_interval(int interval_ms, void (*fn)(void* ctx), void* ctx);
+
+/**
+ * Cancel a timeout or interval
+ * Returns false if the timer already fired (timeouts) or was cancelled
+ */
+bool tui_cancel_timer(int timer_id);
+
+/**
+ * Report mouse movement while no button is held
+ * Off by default: every movement then wakes the event loop and rebuilds
+ * the UI, so only turn this on if the app reacts to hovering. Clicks,
+ * drags and the scroll wheel are always reported.
+ */
+void tui_set_mouse_motion(bool enabled);
+
 /**
  * Get the current terminal dimensions
  * Returns true if successful, false otherwise
@@ -122,6 +168,74 @@ void tui_request_render(void);
  */
 bool tui_get_terminal_size(int* width, int* height);
 
+/**
+ * Statistics for the most recently rendered frame
+ * Times are wall-clock nanoseconds spent in each step of the frame
+ */
+typedef struct {
+    unsigned long syscalls;  // write() calls used to send the frame
+    unsigned long bytes;     // Bytes sent to the terminal
+    unsigned long frame;     // Frames rendered so far, this one included
+    uint64_t build_ns;       // Calling the root function
+    uint64_t measure_ns;     // Measuring component sizes
+    uint64_t position_ns;    // Positioning components
+    uint64_t focus_ns;       // Moving focus onto the new tree
+    uint64_t diff_ns;        // Diffing against the previous frame
+    uint64_t render_ns;      // Drawing and encoding the changed cells
+    uint64_t flush_ns;       // Sending the output
+} tui_frame_stats_t;
+
+/**
+ * Get statistics for the most recently rendered frame
+ * Returns false if no frame has been rendered yet
+ */
+bool tui_get_frame_stats(tui_frame_stats_t* stats);
+
+/* ========== Headless Terminal ========== */
+
+/**
+ * Run without a terminal
+ * Call before tui_init(). Output goes to an in-memory terminal of
+ * width x height cells, input comes only from tui_headless_input(), and
+ * time is virtual: it stands still while frames are built and jumps ahead
+ * whenever the event loop would sleep, so a script always produces the
+ * same frames. tui_run() returns once the input has run out and nothing
+ * is scheduled; apps that keep animating need a 'q' at the end.
+ * Returns false if the cells can't be allocated
+ */
+bool tui_use_headless(int width, int height);
+
+/**
+ * Queue bytes for the headless terminal to "type"
+ * They arrive delay_ms after the previously queued bytes (or after now),
+ * and are read exactly like terminal input: keys, escape sequences,
+ * mouse reports and bracketed pastes.
+ * Returns false if the bytes couldn't be queued
+ */
+bool tui_headless_input(int delay_ms, const char* bytes, size_t length);
+
+/**
+ * One cell of the headless terminal
+ */
+typedef struct {
+    char glyph[5];  // UTF-8 character, NUL-terminated
+    color_t fg;
+    color_t bg;
+    style_t style;
+} tui_cell_t;
+
+/**
+ * Read a cell of the headless terminal
+ * The last frame stays readable after tui_run() returns.
+ * Returns false if (x, y) is outside the terminal
+ */
+bool tui_headless_get_cell(int x, int y, tui_cell_t* cell);
+
+/**
+ * Get the cursor position of the headless terminal
+ */
+bool tui_headless_get_cursor(int* x, int* y);
+
 /* ========== Components ========== */
 
 /**
@@ -132,6 +246,7 @@ typedef struct {
     color_t fg_color;       // Foreground color (default: COLOR_DEFAULT)
     color_t bg_color;       // Background color (default: COLOR_DEFAULT)
     style_t style;          // Text style flags (default: STYLE_NONE, can combine with |)
+    bool borrow;            // Use content in place instead of copying it (default: false)
 } TextConfig;
 
 /**
@@ -157,6 +272,9 @@ typedef struct {
  *       .bg_color = COLOR_BLACK,
  *       .style = STYLE_BOLD | STYLE_UNDERLINE
  *   })
+ *
+ * The content is copied unless config.borrow is set. A borrowed string
+ * must stay valid and unchanged until the next frame is built.
  */
 component_t* Text(const char* content, TextConfig config);
 
@@ -186,6 +304,44 @@ component_t* HStack(component_t* first, ...);
  */
 component_t* VStackArray(component_t** children);
 
+/**
+ * Give a component a stable identity among its siblings
+ * Returns the component itself. When the tree is rebuilt, children of the
+ * same parent are matched by key instead of by position, so inserting,
+ * removing or reordering keyed items only repaints what actually changed,
+ * and state such as scroll animations stays with the right item.
+ * Keys must be unique among siblings; the string is copied.
+ *
+ * Example:
+ *   for (int i = 0; i < count; i++) {
+ *       rows[i] = Keyed(todos[i].id, Text(todos[i].title, TEXT_DEFAULT));
+ *   }
+ *   VStackArray(rows)
+ */
+component_t* Keyed(const char* key, component_t* child);
+
+/**
+ * Build a subtree only when its inputs change
+ * builder(ctx) is called to build the subtree the first time, and again
+ * whenever deps_hash differs from the previous frame. Otherwise the
+ * subtree from the previous frame is reused as is, together with its
+ * layout, and nothing in it is rebuilt or diffed.
+ *
+ * deps_hash must cover everything the builder reads (strings, counters,
+ * state pointers' values). key identifies the memo across frames and must
+ * be unique in the whole tree; a key used twice in one frame is built
+ * without caching. Subtrees that are not used for a frame are discarded.
+ * Anything borrowed inside the subtree must stay valid while it is reused.
+ *
+ * Example:
+ *   static component_t* stats_panel(void* ctx) {
+ *       stats_t* stats = ctx;
+ *       ...
+ *   }
+ *   Memo("stats", stats.version, stats_panel, &stats)
+ */
+component_t* Memo(const char* key, uint64_t deps_hash, component_t* (*builder)(void* ctx), void* ctx);
+
 /**
  * StackConfig for advanced stack layout control
  */
@@ -272,6 +428,10 @@ typedef struct {
     int* scroll_offset;          // Pointer to scroll position (external state, optional)
     int* selected_index;         // Pointer to selected index (external state, optional)
     void (*on_select)(int index); // Callback when Enter pressed on item (optional)
+    bool borrow;                 // Use items in place instead of copying them (default: false)
+    const char* (*item_provider)(int index, void* ctx); // Fetch items on demand instead of items (optional)
+    void* provider_ctx;          // Passed to item_provider
+    int item_width;              // Width of the widest item, if known (0 = measure)
 } ListConfig;
 
 /**
@@ -280,6 +440,23 @@ typedef struct {
  * Shows up to max_visible items at a time, with automatic scrolling
  *
  * Example: List((ListConfig){ .items = items, .count = 5, .max_visible = 10 })
+ *
+ * The items are copied unless config.borrow is set. Borrowed items must
+ * stay valid and unchanged until the next frame is built.
+ *
+ * For very long lists, set item_provider instead of items. The list then
+ * asks for the rows it shows and nothing else, so a frame costs the same
+ * for a million rows as for ten. The returned string only has to stay
+ * valid until the next call. Set item_width as well, or the width is
+ * measured from the visible rows alone and follows the scroll position.
+ *
+ * Example (data source):
+ *   static const char* log_line(int index, void* ctx) {
+ *       return ((log_t*)ctx)->lines[index];
+ *   }
+ *   List((ListConfig){ .item_provider = log_line, .provider_ctx = &log,
+ *                      .count = log.count, .item_width = 80,
+ *                      .scroll_offset = &scroll })
  */
 component_t* List(ListConfig config);
 
@@ -355,6 +532,14 @@ typedef struct {
     int column_count;        // Number of columns
     int row_count;           // Number of rows
     bool show_borders;       // Show borders around cells (default: true)
+    bool borrow;             // Use headers and rows in place instead of copying them (default: false)
+    const char** (*row_provider)(int row, void* ctx); // Fetch rows on demand instead of rows (optional)
+    void* provider_ctx;      // Passed to row_provider
+    const int* column_widths; // Fixed width of each column (optional, otherwise measured)
+    int max_visible;         // Maximum visible rows (default: all rows)
+    int* scroll_offset;      // Pointer to first visible row (external state, optional)
+    int* selected_row;       // Pointer to selected row (external state, optional)
+    void (*on_select)(int row); // Callback when Enter pressed on a row (optional)
 } TableConfig;
 
 /**
@@ -373,6 +558,32 @@ typedef struct {
  *       .row_count = 2,
  *       .show_borders = true
  *   })
+ *
+ * Headers and cells are copied unless config.borrow is set. With borrow,
+ * the arrays and strings are used in place and must stay valid and
+ * unchanged until the next frame is built; large tables then cost no
+ * per-cell allocations, and column widths are estimated from a sample of
+ * rows as for row_provider below.
+ *
+ * Set max_visible to show a window of rows that follows *scroll_offset;
+ * with selected_row the table becomes focusable and Up/Down move the
+ * selection. For large data sets, set row_provider instead of rows: it is
+ * asked only for the rows in view and returns column_count strings that
+ * only have to stay valid until the next call. Column widths then come
+ * from column_widths, or are estimated from the headers and a sample of
+ * rows; longer cells are truncated.
+ *
+ * Example (data source):
+ *   static const char** process_row(int row, void* ctx) {
+ *       static const char* cells[3];
+ *       ... fill cells for row ...
+ *       return cells;
+ *   }
+ *   Table((TableConfig){
+ *       .headers = headers, .column_count = 3,
+ *       .row_provider = process_row, .row_count = process_count,
+ *       .max_visible = 20, .scroll_offset = &scroll, .selected_row = &selected
+ *   })
  */
 component_t* Table(TableConfig config);
 
@@ -437,12 +648,15 @@ typedef struct {
     bool* is_visible;           // Pointer to visibility state
     toast_position_t position;  // Position on screen (default: TOAST_BOTTOM)
     void (*on_close)(void);     // Optional callback when toast closes (can be NULL)
+    int duration_ms;            // Hide automatically after this long (0 = stay until hidden)
 } ToastConfig;
 
 /**
  * Create a Toast notification component
  * Displays a temporary message at specified position
- * Only renders when *is_visible is true
+ * Only renders when *is_visible is true. With duration_ms set, a timer
+ * clears *is_visible and calls on_close once the toast has been shown
+ * for that long.
  *
  * Example:
  *   bool show_toast = true;
@@ -450,7 +664,8 @@ typedef struct {
  *       .message = "File saved!",
  *       .is_visible = &show_toast,
  *       .position = TOAST_BOTTOM,
- *       .on_close = close_toast
+ *       .on_close = close_toast,
+ *       .duration_ms = 3000
  *   })
  */
 component_t* Toast(ToastConfig config);
@@ -1,11 +1,10 @@
 #include "internal/animation.h"
+#include "internal/backend.h"
 #include <stdlib.h>
 #include <math.h>
 
 uint64_t anim_get_time_us(void) {
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return (uint64_t)tv.tv_sec * 1000000 + (uint64_t)tv.tv_usec;
+    return backend_get()->now_us();
 }
 
 float anim_delta_time(uint64_t start_us, uint64_t end_us) {
@@ -98,6 +97,15 @@ void anim_start(animation_t* anim) {
     anim->completed = false;
 }
 
+void anim_cancel(animation_t* anim) {
+    if (!anim) {
+        return;
+    }
+
+    anim->active = false;
+    anim->completed = true;
+}
+
 bool anim_update(animation_t* anim) {
     if (!anim || !anim->active || anim->completed) {
         return false;
@@ -0,0 +1,92 @@
+#include "internal/arena.h"
+#include <stdlib.h>
+
+#define ARENA_ALIGNMENT (sizeof(void*) > sizeof(double) ? sizeof(void*) : sizeof(double))
+
+static size_t align_up(size_t size) {
+    return (size + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+}
+
+static arena_block_t* block_create(size_t size) {
+    arena_block_t* block = malloc(sizeof(arena_block_t) + size);
+    if (!block) {
+        return NULL;
+    }
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+    return block;
+}
+
+void arena_init(arena_t* arena, size_t block_size) {
+    if (!arena) {
+        return;
+    }
+    arena->blocks = NULL;
+    arena->block_size = block_size > 0 ? block_size : 64 * 1024;
+    arena->total_used = 0;
+}
+
+void* arena_alloc(arena_t* arena, size_t size) {
+    if (!arena) {
+        return NULL;
+    }
+
+    size = align_up(size > 0 ? size : 1);
+
+    arena_block_t* block = arena->blocks;
+    if (!block || block->size - block->used < size) {
+        // Start a new block; oversized requests get a block of their own
+        size_t block_size = size > arena->block_size ? size : arena->block_size;
+        arena_block_t* new_block = block_create(block_size);
+        if (!new_block) {
+            return NULL;
+        }
+        new_block->next = block;
+        arena->blocks = new_block;
+        block = new_block;
+    }
+
+    void* ptr = block->data + block->used;
+    block->used += size;
+    arena->total_used += size;
+    return ptr;
+}
+
+void arena_reset(arena_t* arena) {
+    if (!arena || !arena->blocks) {
+        return;
+    }
+
+    if (arena->blocks->next) {
+        // Last cycle overflowed: replace the chain with one block big enough
+        size_t total = 0;
+        arena_block_t* block = arena->blocks;
+        while (block) {
+            arena_block_t* next = block->next;
+            total += block->size;
+            free(block);
+            block = next;
+        }
+        arena->blocks = block_create(total);
+    } else {
+        arena->blocks->used = 0;
+    }
+
+    arena->total_used = 0;
+}
+
+void arena_free(arena_t* arena) {
+    if (!arena) {
+        return;
+    }
+
+    arena_block_t* block = arena->blocks;
+    while (block) {
+        arena_block_t* next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->blocks = NULL;
+    arena->total_used = 0;
+}
@@ -0,0 +1,181 @@
+// select() and the termios/ioctl calls are POSIX, not standard C
+#define _POSIX_C_SOURCE 200809L
+#define _DARWIN_C_SOURCE
+
+#include "internal/backend.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/ioctl.h>
+#include <sys/select.h>
+#include <sys/time.h>
+
+static const backend_t* current_backend = &backend_tty;
+
+const backend_t* backend_get(void) {
+    return current_backend;
+}
+
+void backend_set(const backend_t* backend) {
+    current_backend = backend ? backend : &backend_tty;
+}
+
+/* ========== tty backend ========== */
+
+// Original terminal settings to restore on cleanup
+static struct termios original_termios;
+static bool termios_saved = false;
+
+static bool tty_init(void) {
+    // Save current terminal settings
+    if (tcgetattr(STDIN_FILENO, &original_termios) == -1) {
+        perror("tcgetattr");
+        return false;
+    }
+    termios_saved = true;
+
+    // Configure terminal for raw mode
+    struct termios raw = original_termios;
+
+    // Disable canonical mode (line buffering) and echo
+    raw.c_lflag &= ~(ECHO | ICANON | ISIG | IEXTEN);
+
+    // Disable input processing
+    raw.c_iflag &= ~(IXON | ICRNL | BRKINT | INPCK | ISTRIP);
+
+    // Disable output processing
+    raw.c_oflag &= ~(OPOST);
+
+    // Set character size to 8 bits
+    raw.c_cflag |= (CS8);
+
+    // Read returns immediately with any data
+    raw.c_cc[VMIN] = 0;
+    raw.c_cc[VTIME] = 1;
+
+    // Apply settings
+    if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw) == -1) {
+        perror("tcsetattr");
+        return false;
+    }
+    return true;
+}
+
+static void tty_cleanup(void) {
+    // Restore original terminal settings
+    if (termios_saved) {
+        tcsetattr(STDIN_FILENO, TCSAFLUSH, &original_termios);
+        termios_saved = false;
+    }
+}
+
+static ssize_t tty_write(const char* data, size_t len) {
+    return write(STDOUT_FILENO, data, len);
+}
+
+static bool tty_get_size(int* width, int* height) {
+    struct winsize ws;
+
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == -1) {
+        perror("ioctl");
+        return false;
+    }
+
+    *width = ws.ws_col;
+    *height = ws.ws_row;
+    return true;
+}
+
+static int tty_wait(int wake_fd, int timeout_ms) {
+    fd_set readfds;
+    FD_ZERO(&readfds);
+    FD_SET(STDIN_FILENO, &readfds);
+    int max_fd = STDIN_FILENO;
+    if (wake_fd != -1) {
+        FD_SET(wake_fd, &readfds);
+        if (wake_fd > max_fd) {
+            max_fd = wake_fd;
+        }
+    }
+
+    struct timeval timeout;
+    struct timeval* timeout_ptr = NULL;
+    if (timeout_ms >= 0) {
+        timeout.tv_sec = timeout_ms / 1000;
+        timeout.tv_usec = (timeout_ms % 1000) * 1000;
+        timeout_ptr = &timeout;
+    }
+
+    if (select(max_fd + 1, &readfds, NULL, NULL, timeout_ptr) <= 0) {
+        // Timeout, or a signal such as SIGWINCH
+        return 0;
+    }
+
+    int ready = 0;
+    if (FD_ISSET(STDIN_FILENO, &readfds)) {
+        ready |= BACKEND_INPUT;
+    }
+    if (wake_fd != -1 && FD_ISSET(wake_fd, &readfds)) {
+        ready |= BACKEND_WAKE;
+    }
+    return ready;
+}
+
+static ssize_t tty_read(unsigned char* buffer, size_t size) {
+    return read(STDIN_FILENO, buffer, size);
+}
+
+static uint64_t tty_now_us(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint64_t)tv.tv_sec * 1000000 + (uint64_t)tv.tv_usec;
+}
+
+/**
+ * Recognize terminals known to implement REP from the environment
+ * Terminals don't report it, and unsupported ones drop the repeats
+ */
+static bool tty_supports_repeat(void) {
+    static const char* const term_prefixes[] = {
+        "xterm-kitty", "xterm-ghostty", "alacritty", "foot", "wezterm", "contour",
+    };
+
+    // GNU screen doesn't implement REP, and passes on the environment of
+    // the terminal it was started from
+    const char* term = getenv("TERM");
+    if (getenv("STY") || (term && strncmp(term, "screen", 6) == 0)) {
+        return false;
+    }
+
+    // XTerm itself exports its version; VTE has REP since 0.54
+    if (getenv("XTERM_VERSION")) {
+        return true;
+    }
+    const char* vte_version = getenv("VTE_VERSION");
+    if (vte_version && atoi(vte_version) >= 5400) {
+        return true;
+    }
+
+    if (!term) {
+        return false;
+    }
+    for (size_t i = 0; i < sizeof(term_prefixes) / sizeof(term_prefixes[0]); i++) {
+        if (strncmp(term, term_prefixes[i], strlen(term_prefixes[i])) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const backend_t backend_tty = {
+    tty_init,
+    tty_cleanup,
+    tty_write,
+    tty_get_size,
+    tty_wait,
+    tty_read,
+    tty_now_us,
+    tty_supports_repeat,
+};
@@ -3,8 +3,49 @@
 #include <string.h>
 #include <stdbool.h>
 
+// Allocator for components built from now on (NULL = heap)
+static arena_t* current_arena = NULL;
+
+void component_use_arena(arena_t* arena) {
+    current_arena = arena;
+}
+
+arena_t* component_get_arena(void) {
+    return current_arena;
+}
+
+void* component_alloc(size_t size) {
+    if (current_arena) {
+        void* ptr = arena_alloc(current_arena, size);
+        if (ptr) {
+            memset(ptr, 0, size);
+        }
+        return ptr;
+    }
+    return calloc(1, size);
+}
+
+char* component_strdup(const char* str) {
+    if (!str) {
+        return NULL;
+    }
+
+    size_t len = strlen(str) + 1;
+    char* copy = current_arena ? arena_alloc(current_arena, len) : malloc(len);
+    if (copy) {
+        memcpy(copy, str, len);
+    }
+    return copy;
+}
+
+void component_dealloc(void* ptr) {
+    if (!current_arena) {
+        free(ptr);
+    }
+}
+
 struct component_t* component_create(component_type_t type) {
-    struct component_t* component = calloc(1, sizeof(struct component_t));
+    struct component_t* component = component_alloc(sizeof(struct component_t));
     if (!component) {
         return NULL;
     }
@@ -26,6 +67,8 @@ struct component_t* component_create(component_type_t type) {
     component->style = STYLE_NONE;
     component->dirty = true;  // New components are dirty
     component->content_hash = 0;
+    component->key = NULL;
+    component->arena_owned = current_arena != NULL;
 
     return component;
 }
@@ -38,8 +81,21 @@ bool component_add_child(struct component_t* parent, struct component_t* child)
     // Grow children array if needed
     if (parent->child_count >= parent->child_capacity) {
         int new_capacity = parent->child_capacity == 0 ? 4 : parent->child_capacity * 2;
-        struct component_t** new_children = realloc(parent->children,
-                                             new_capacity * sizeof(struct component_t*));
+        struct component_t** new_children;
+
+        if (parent->arena_owned && current_arena) {
+            // Arena memory can't be resized in place; the old array is
+            // simply abandoned until the arena is reset
+            new_children = arena_alloc(current_arena, new_capacity * sizeof(struct component_t*));
+            if (new_children && parent->child_count > 0) {
+                memcpy(new_children, parent->children,
+                       parent->child_count * sizeof(struct component_t*));
+            }
+        } else {
+            new_children = realloc(parent->children,
+                                   new_capacity * sizeof(struct component_t*));
+        }
+
         if (!new_children) {
             return false;
         }
@@ -51,8 +107,37 @@ bool component_add_child(struct component_t* parent, struct component_t* child)
     return true;
 }
 
+void component_cancel_animations(struct component_t* component) {
+    // Memoized subtrees may be reused elsewhere; the memo cache cancels
+    // their animations when it frees them
+    if (!component || component->type == COMPONENT_MEMO) {
+        return;
+    }
+
+    if (component->data) {
+        if (component->type == COMPONENT_LIST) {
+            list_data_t* list_data = (list_data_t*)component->data;
+            anim_cancel(list_data->scroll_animation);
+            list_data->scroll_animation = NULL;
+        } else if (component->type == COMPONENT_SCROLLVIEW) {
+            scrollview_data_t* scrollview_data = (scrollview_data_t*)component->data;
+            anim_cancel(scrollview_data->scroll_animation);
+            scrollview_data->scroll_animation = NULL;
+            component_cancel_animations(scrollview_data->content);
+        } else if (component->type == COMPONENT_MODAL) {
+            component_cancel_animations(((modal_data_t*)component->data)->content);
+        } else if (component->type == COMPONENT_PADDING) {
+            component_cancel_animations(((padding_data_t*)component->data)->child);
+        }
+    }
+
+    for (int i = 0; i < component->child_count; i++) {
+        component_cancel_animations(component->children[i]);
+    }
+}
+
 void component_free(struct component_t* component) {
-    if (!component) {
+    if (!component || component->arena_owned) {
         return;
     }
 
@@ -61,7 +146,9 @@ void component_free(struct component_t* component) {
         switch (component->type) {
             case COMPONENT_TEXT: {
                 text_data_t* text_data = (text_data_t*)component->data;
-                free(text_data->content);
+                if (!text_data->borrowed) {
+                    free((char*)text_data->content);
+                }
                 free(text_data);
                 break;
             }
@@ -78,15 +165,13 @@ void component_free(struct component_t* component) {
             }
             case COMPONENT_LIST: {
                 list_data_t* list_data = (list_data_t*)component->data;
-                if (list_data->items) {
+                if (list_data->items && !list_data->borrowed) {
                     for (int i = 0; i < list_data->item_count; i++) {
-                        free(list_data->items[i]);
+                        free((char*)list_data->items[i]);
                     }
                     free(list_data->items);
                 }
-                if (list_data->scroll_animation) {
-                    anim_free(list_data->scroll_animation);
-                }
+                anim_cancel(list_data->scroll_animation);
                 free(list_data);
                 break;
             }
@@ -100,25 +185,23 @@ void component_free(struct component_t* component) {
             case COMPONENT_SCROLLVIEW: {
                 scrollview_data_t* scrollview_data = (scrollview_data_t*)component->data;
                 component_free(scrollview_data->content);
-                if (scrollview_data->scroll_animation) {
-                    anim_free(scrollview_data->scroll_animation);
-                }
+                anim_cancel(scrollview_data->scroll_animation);
                 free(scrollview_data);
                 break;
             }
             case COMPONENT_TABLE: {
                 table_data_t* table_data = (table_data_t*)component->data;
-                if (table_data->headers) {
+                if (table_data->headers && !table_data->borrowed) {
                     for (int i = 0; i < table_data->header_count; i++) {
-                        free(table_data->headers[i]);
+                        free((char*)table_data->headers[i]);
                     }
                     free(table_data->headers);
                 }
-                if (table_data->rows) {
+                if (table_data->rows && !table_data->borrowed) {
                     for (int r = 0; r < table_data->row_count; r++) {
                         if (table_data->rows[r]) {
                             for (int c = 0; c < table_data->header_count; c++) {
-                                free(table_data->rows[r][c]);
+                                free((char*)table_data->rows[r][c]);
                             }
                             free(table_data->rows[r]);
                         }
@@ -153,6 +236,7 @@ void component_free(struct component_t* component) {
                 break;
             case COMPONENT_VSTACK:
             case COMPONENT_HSTACK:
+            case COMPONENT_MEMO:
                 // Check if there's stack_data (for aligned stacks)
                 if (component->data) {
                     free(component->data);
@@ -161,13 +245,16 @@ void component_free(struct component_t* component) {
         }
     }
 
-    // Recursively free all children
-    for (int i = 0; i < component->child_count; i++) {
-        component_free(component->children[i]);
+    // Recursively free all children; a memo's child belongs to the memo cache
+    if (component->type != COMPONENT_MEMO) {
+        for (int i = 0; i < component->child_count; i++) {
+            component_free(component->children[i]);
+        }
     }
     free(component->children);
 
     // Free the component itself
+    free((char*)component->key);
     free(component);
 }
 
@@ -16,7 +16,7 @@ component_t* AlignedVStack(StackConfig config) {
     }
 
     // Set alignment and spacing data
-    stack_data_t* data = calloc(1, sizeof(stack_data_t));
+    stack_data_t* data = component_alloc(sizeof(stack_data_t));
     if (!data) {
         component_free(vstack);
         return NULL;
@@ -44,7 +44,7 @@ component_t* AlignedHStack(StackConfig config) {
     }
 
     // Set alignment and spacing data
-    stack_data_t* data = calloc(1, sizeof(stack_data_t));
+    stack_data_t* data = component_alloc(sizeof(stack_data_t));
     if (!data) {
         component_free(hstack);
         return NULL;
@@ -13,15 +13,15 @@ component_t* Button(const char* label, void (*on_click)(void)) {
         return NULL;
     }
 
-    button_data_t* data = malloc(sizeof(button_data_t));
+    button_data_t* data = component_alloc(sizeof(button_data_t));
     if (!data) {
         component_free(component);
         return NULL;
     }
 
-    data->label = strdup(label);
+    data->label = component_strdup(label);
     if (!data->label) {
-        free(data);
+        component_dealloc(data);
         component_free(component);
         return NULL;
     }
@@ -13,7 +13,7 @@ component_t* Input(InputConfig config) {
         return NULL;
     }
 
-    input_data_t* data = malloc(sizeof(input_data_t));
+    input_data_t* data = component_alloc(sizeof(input_data_t));
     if (!data) {
         component_free(component);
         return NULL;
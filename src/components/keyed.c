@@ -0,0 +1,20 @@
+#include "../include/intuitive.h"
+#include "internal/component.h"
+
+component_t* Keyed(const char* key, component_t* child) {
+    if (!child) {
+        return NULL;
+    }
+
+    if (key) {
+        const char* copy = component_strdup(key);
+        if (!copy) {
+            component_free(child);
+            return NULL;
+        }
+        component_dealloc((char*)child->key);
+        child->key = copy;
+    }
+
+    return child;
+}
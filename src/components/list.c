@@ -4,7 +4,7 @@
 #include <string.h>
 
 component_t* List(ListConfig config) {
-    if (!config.items || config.count <= 0) {
+    if ((!config.items && !config.item_provider) || config.count <= 0) {
         return NULL;
     }
 
@@ -13,33 +13,43 @@ component_t* List(ListConfig config) {
         return NULL;
     }
 
-    list_data_t* data = calloc(1, sizeof(list_data_t));
+    list_data_t* data = component_alloc(sizeof(list_data_t));
     if (!data) {
         component_free(list);
         return NULL;
     }
 
-    data->items = calloc(config.count, sizeof(char*));
-    if (!data->items) {
-        free(data);
-        component_free(list);
-        return NULL;
-    }
+    // Attach the data first so component_free() can unwind a partial copy
+    component_set_data(list, data);
+    data->item_count = config.count;
+    data->borrowed = config.borrow;
 
-    for (int i = 0; i < config.count; i++) {
-        data->items[i] = strdup(config.items[i]);
-        if (!data->items[i]) {
-            for (int j = 0; j < i; j++) {
-                free(data->items[j]);
-            }
-            free(data->items);
-            free(data);
+    data->item_provider = config.item_provider;
+    data->provider_ctx = config.provider_ctx;
+    data->item_width = config.item_width > 0 ? config.item_width : 0;
+
+    if (config.item_provider) {
+        // Rows are fetched on demand; nothing to copy
+        data->items = NULL;
+    } else if (config.borrow) {
+        data->items = config.items;
+    } else {
+        // Zeroed, so slots not yet filled are NULL
+        data->items = component_alloc(config.count * sizeof(char*));
+        if (!data->items) {
             component_free(list);
             return NULL;
         }
+
+        for (int i = 0; i < config.count; i++) {
+            data->items[i] = component_strdup(config.items[i]);
+            if (!data->items[i]) {
+                component_free(list);
+                return NULL;
+            }
+        }
     }
 
-    data->item_count = config.count;
     data->scroll_offset = config.scroll_offset;
     data->max_visible_items = config.max_visible > 0 ? config.max_visible : 10;
     data->selected_index = config.selected_index;
@@ -50,8 +60,6 @@ component_t* List(ListConfig config) {
     data->target_scroll_offset = 0;
     data->scroll_animation = NULL;
 
-    component_set_data(list, data);
-
     // Make list focusable if it has selection support
     if (data->selected_index != NULL) {
         list->focusable = true;
@@ -59,3 +67,25 @@ component_t* List(ListConfig config) {
 
     return list;
 }
+
+const char* list_get_item(list_data_t* data, int index) {
+    if (!data || index < 0 || index >= data->item_count) {
+        return "";
+    }
+
+    const char* item = data->items ? data->items[index]
+                                   : data->item_provider(index, data->provider_ctx);
+    return item ? item : "";
+}
+
+void list_get_visible_range(list_data_t* data, int* start, int* end) {
+    int first = data->scroll_offset ? *data->scroll_offset : 0;
+    if (first > data->item_count) first = data->item_count;
+    if (first < 0) first = 0;
+
+    int last = first + data->max_visible_items;
+    if (last > data->item_count) last = data->item_count;
+
+    *start = first;
+    *end = last;
+}
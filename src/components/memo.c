@@ -0,0 +1,41 @@
+#include "../include/intuitive.h"
+#include "internal/component.h"
+#include "internal/memo.h"
+
+component_t* Memo(const char* key, uint64_t deps_hash, component_t* (*builder)(void* ctx), void* ctx) {
+    if (!key || !builder) {
+        return NULL;
+    }
+
+    bool reused = false;
+    bool built = false;
+    memo_entry_t* entry = NULL;
+    component_t* subtree = memo_get(key, deps_hash, builder, ctx, &reused, &built, &entry);
+    if (!subtree) {
+        // A failed build isn't retried, since the builder can have side
+        // effects. Otherwise it's not cacheable (duplicate key or no memory
+        // for the entry): build it like any other component
+        return built ? NULL : builder(ctx);
+    }
+
+    component_t* memo = component_create(COMPONENT_MEMO);
+    if (!memo) {
+        return NULL;
+    }
+
+    memo_data_t* data = component_alloc(sizeof(memo_data_t));
+    if (!data) {
+        component_free(memo);
+        return NULL;
+    }
+    data->reused = reused;
+    data->entry = entry;
+    component_set_data(memo, data);
+
+    if (!component_add_child(memo, subtree)) {
+        component_free(memo);
+        return NULL;
+    }
+
+    return memo;
+}
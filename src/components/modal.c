@@ -13,14 +13,14 @@ component_t* Modal(ModalConfig config) {
         return NULL;
     }
 
-    modal_data_t* data = calloc(1, sizeof(modal_data_t));
+    modal_data_t* data = component_alloc(sizeof(modal_data_t));
     if (!data) {
         component_free(modal);
         return NULL;
     }
 
     data->is_open = config.is_open;
-    data->title = config.title ? strdup(config.title) : NULL;
+    data->title = config.title ? component_strdup(config.title) : NULL;
     data->content = config.content;
     data->on_close = config.on_close;
 
@@ -13,7 +13,7 @@ component_t* Padded(component_t* child, PaddingConfig padding) {
         return NULL;
     }
 
-    padding_data_t* data = calloc(1, sizeof(padding_data_t));
+    padding_data_t* data = component_alloc(sizeof(padding_data_t));
     if (!data) {
         component_free(child);
         component_free(padded);
@@ -12,7 +12,7 @@ component_t* ScrollView(component_t* content, int* scroll_offset, ScrollConfig c
         return NULL;
     }
 
-    scrollview_data_t* data = calloc(1, sizeof(scrollview_data_t));
+    scrollview_data_t* data = component_alloc(sizeof(scrollview_data_t));
     if (!data) {
         component_free(scrollview);
         return NULL;
@@ -53,7 +53,7 @@ component_t* Spinner(SpinnerConfig config) {
         return NULL;
     }
 
-    spinner_data_t* data = (spinner_data_t*)malloc(sizeof(spinner_data_t));
+    spinner_data_t* data = component_alloc(sizeof(spinner_data_t));
     if (!data) {
         component_free(comp);
         return NULL;
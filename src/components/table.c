@@ -3,8 +3,19 @@
 #include <stdlib.h>
 #include <string.h>
 
+// Rows sampled to estimate column widths for rows that aren't copied
+#define TABLE_WIDTH_SAMPLE_ROWS 32
+
+/**
+ * Width of a cell, treating missing cells as empty
+ */
+static int cell_width(const char** row, int col) {
+    return row && row[col] ? (int)strlen(row[col]) : 0;
+}
+
 component_t* Table(TableConfig config) {
-    if (!config.headers || !config.rows || config.column_count <= 0 || config.row_count <= 0) {
+    if (!config.headers || (!config.rows && !config.row_provider) ||
+        config.column_count <= 0 || config.row_count <= 0) {
         return NULL;
     }
 
@@ -13,126 +24,136 @@ component_t* Table(TableConfig config) {
         return NULL;
     }
 
-    table_data_t* data = calloc(1, sizeof(table_data_t));
+    table_data_t* data = component_alloc(sizeof(table_data_t));
     if (!data) {
         component_free(table);
         return NULL;
     }
 
-    // Copy headers
-    data->headers = calloc(config.column_count, sizeof(char*));
-    if (!data->headers) {
-        free(data);
-        component_free(table);
-        return NULL;
+    // Attach the data first so component_free() can unwind a partial copy
+    component_set_data(table, data);
+    data->header_count = config.column_count;
+    data->row_count = config.row_count;
+    data->show_borders = config.show_borders;
+    data->borrowed = config.borrow;
+    data->row_provider = config.row_provider;
+    data->provider_ctx = config.provider_ctx;
+    data->max_visible_rows = config.max_visible > 0 ? config.max_visible : config.row_count;
+    data->scroll_offset = config.scroll_offset;
+    data->selected_row = config.selected_row;
+    data->on_select = config.on_select;
+
+    // Make table focusable if it has selection support
+    if (data->selected_row != NULL) {
+        table->focusable = true;
     }
 
-    for (int i = 0; i < config.column_count; i++) {
-        data->headers[i] = strdup(config.headers[i]);
-        if (!data->headers[i]) {
-            for (int j = 0; j < i; j++) {
-                free(data->headers[j]);
-            }
-            free(data->headers);
-            free(data);
+    if (config.borrow) {
+        data->headers = config.headers;
+        data->rows = config.row_provider ? NULL : config.rows;
+    } else {
+        // The arrays are zeroed, so slots not yet filled are NULL
+        data->headers = component_alloc(config.column_count * sizeof(char*));
+        if (!data->headers) {
             component_free(table);
             return NULL;
         }
-    }
 
-    // Copy rows
-    data->rows = calloc(config.row_count, sizeof(char**));
-    if (!data->rows) {
         for (int i = 0; i < config.column_count; i++) {
-            free(data->headers[i]);
+            data->headers[i] = component_strdup(config.headers[i]);
+            if (!data->headers[i]) {
+                component_free(table);
+                return NULL;
+            }
         }
-        free(data->headers);
-        free(data);
-        component_free(table);
-        return NULL;
-    }
 
-    for (int row = 0; row < config.row_count; row++) {
-        data->rows[row] = calloc(config.column_count, sizeof(char*));
-        if (!data->rows[row]) {
-            // Cleanup previously allocated rows
-            for (int r = 0; r < row; r++) {
-                for (int c = 0; c < config.column_count; c++) {
-                    free(data->rows[r][c]);
-                }
-                free(data->rows[r]);
-            }
-            free(data->rows);
-            for (int i = 0; i < config.column_count; i++) {
-                free(data->headers[i]);
+        if (config.row_provider) {
+            // Rows are fetched on demand; nothing more to copy
+            data->rows = NULL;
+        } else {
+            data->rows = component_alloc(config.row_count * sizeof(char**));
+            if (!data->rows) {
+                component_free(table);
+                return NULL;
             }
-            free(data->headers);
-            free(data);
-            component_free(table);
-            return NULL;
-        }
 
-        for (int col = 0; col < config.column_count; col++) {
-            data->rows[row][col] = strdup(config.rows[row][col]);
-            if (!data->rows[row][col]) {
-                // Cleanup
-                for (int c = 0; c < col; c++) {
-                    free(data->rows[row][c]);
+            for (int row = 0; row < config.row_count; row++) {
+                data->rows[row] = component_alloc(config.column_count * sizeof(char*));
+                if (!data->rows[row]) {
+                    component_free(table);
+                    return NULL;
                 }
-                for (int r = 0; r < row; r++) {
-                    for (int c = 0; c < config.column_count; c++) {
-                        free(data->rows[r][c]);
+
+                for (int col = 0; col < config.column_count; col++) {
+                    data->rows[row][col] = component_strdup(config.rows[row][col]);
+                    if (!data->rows[row][col]) {
+                        component_free(table);
+                        return NULL;
                     }
-                    free(data->rows[r]);
                 }
-                free(data->rows[row]);
-                free(data->rows);
-                for (int i = 0; i < config.column_count; i++) {
-                    free(data->headers[i]);
-                }
-                free(data->headers);
-                free(data);
-                component_free(table);
-                return NULL;
             }
         }
     }
 
-    data->header_count = config.column_count;
-    data->row_count = config.row_count;
-    data->show_borders = config.show_borders;
-
-    // Calculate column widths (max of header and all rows)
-    data->column_widths = calloc(config.column_count, sizeof(int));
+    data->column_widths = component_alloc(config.column_count * sizeof(int));
     if (!data->column_widths) {
-        // Cleanup all allocated memory
-        for (int r = 0; r < config.row_count; r++) {
-            for (int c = 0; c < config.column_count; c++) {
-                free(data->rows[r][c]);
-            }
-            free(data->rows[r]);
-        }
-        free(data->rows);
-        for (int i = 0; i < config.column_count; i++) {
-            free(data->headers[i]);
-        }
-        free(data->headers);
-        free(data);
         component_free(table);
         return NULL;
     }
 
-    for (int col = 0; col < config.column_count; col++) {
-        int max_width = strlen(config.headers[col]);
-        for (int row = 0; row < config.row_count; row++) {
-            int cell_width = strlen(config.rows[row][col]);
-            if (cell_width > max_width) {
-                max_width = cell_width;
+    if (config.column_widths) {
+        memcpy(data->column_widths, config.column_widths, config.column_count * sizeof(int));
+    } else if (config.row_provider || config.borrow) {
+        // Rows that aren't copied may be many and are rebuilt every frame:
+        // estimate from the headers and an even sample of rows, so widths
+        // don't shift as the table scrolls; longer cells are truncated
+        int samples = config.row_count < TABLE_WIDTH_SAMPLE_ROWS ?
+                      config.row_count : TABLE_WIDTH_SAMPLE_ROWS;
+        for (int col = 0; col < config.column_count; col++) {
+            data->column_widths[col] = strlen(config.headers[col]);
+        }
+        for (int i = 0; i < samples; i++) {
+            int row = (int)((long long)i * config.row_count / samples);
+            const char** cells = table_get_row(data, row);
+            for (int col = 0; col < config.column_count; col++) {
+                int width = cell_width(cells, col);
+                if (width > data->column_widths[col]) {
+                    data->column_widths[col] = width;
+                }
             }
         }
-        data->column_widths[col] = max_width;
+    } else {
+        // Rows were just copied anyway: max of header and all rows
+        for (int col = 0; col < config.column_count; col++) {
+            int max_width = strlen(config.headers[col]);
+            for (int row = 0; row < config.row_count; row++) {
+                int width = cell_width(config.rows[row], col);
+                if (width > max_width) {
+                    max_width = width;
+                }
+            }
+            data->column_widths[col] = max_width;
+        }
     }
 
-    component_set_data(table, data);
     return table;
 }
+
+const char** table_get_row(table_data_t* data, int row) {
+    if (!data || row < 0 || row >= data->row_count) {
+        return NULL;
+    }
+    return data->rows ? data->rows[row] : data->row_provider(row, data->provider_ctx);
+}
+
+void table_get_visible_range(table_data_t* data, int* start, int* end) {
+    int first = data->scroll_offset ? *data->scroll_offset : 0;
+    if (first > data->row_count) first = data->row_count;
+    if (first < 0) first = 0;
+
+    int last = first + data->max_visible_rows;
+    if (last > data->row_count) last = data->row_count;
+
+    *start = first;
+    *end = last;
+}
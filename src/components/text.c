@@ -13,15 +13,17 @@ component_t* Text(const char* content, TextConfig config) {
         return NULL;
     }
 
-    text_data_t* data = malloc(sizeof(text_data_t));
+    text_data_t* data = component_alloc(sizeof(text_data_t));
     if (!data) {
         component_free(component);
         return NULL;
     }
 
-    data->content = strdup(content);
+    data->length = (int)strlen(content);
+    data->borrowed = config.borrow;
+    data->content = config.borrow ? content : component_strdup(content);
     if (!data->content) {
-        free(data);
+        component_dealloc(data);
         component_free(component);
         return NULL;
     }
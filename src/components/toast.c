@@ -4,25 +4,124 @@
 #include <string.h>
 #include <stdio.h>
 
+// Auto-dismiss timers. Toasts are rebuilt every frame, so a timer belongs
+// to the visibility flag it clears rather than to a component.
+#define MAX_TOAST_TIMERS 16
+
+typedef struct {
+    bool* is_visible;  // NULL = free slot
+    void (*on_close)(void);
+    int timer_id;
+} toast_timer_t;
+
+static toast_timer_t toast_timers[MAX_TOAST_TIMERS];
+
+static toast_timer_t* find_toast_timer(bool* is_visible) {
+    for (int i = 0; i < MAX_TOAST_TIMERS; i++) {
+        if (toast_timers[i].is_visible == is_visible) {
+            return &toast_timers[i];
+        }
+    }
+    return NULL;
+}
+
+static void dismiss_toast(void* ctx) {
+    toast_timer_t* timer = (toast_timer_t*)ctx;
+    bool* is_visible = timer->is_visible;
+    void (*on_close)(void) = timer->on_close;
+
+    timer->is_visible = NULL;
+    *is_visible = false;
+    if (on_close) {
+        on_close();
+    }
+}
+
+/**
+ * Start the dismiss timer when a toast appears and drop it when the
+ * toast is hidden some other way
+ */
+static void update_toast_timer(ToastConfig* config) {
+    toast_timer_t* timer = find_toast_timer(config->is_visible);
+
+    if (!*config->is_visible || config->duration_ms <= 0) {
+        if (timer) {
+            tui_cancel_timer(timer->timer_id);
+            timer->is_visible = NULL;
+        }
+        return;
+    }
+
+    if (timer) {
+        // Already counting down
+        timer->on_close = config->on_close;
+        return;
+    }
+
+    timer = find_toast_timer(NULL);
+    if (!timer) {
+        // Too many toasts at once; this one stays until hidden
+        return;
+    }
+
+    timer->timer_id = tui_set_timeout(config->duration_ms, dismiss_toast, timer);
+    if (timer->timer_id) {
+        timer->is_visible = config->is_visible;
+        timer->on_close = config->on_close;
+    }
+}
+
+void toast_reset(void) {
+    memset(toast_timers, 0, sizeof(toast_timers));
+}
+
+void toast_get_rect(toast_data_t* data, int screen_width, int screen_height,
+                    int* x, int* y, int* width, int* height) {
+    *width = (int)strlen(data->message) + 4;  // +4 for borders and padding
+    *height = 3;  // Top border, message, bottom border
+
+    switch (data->position) {
+        case TOAST_TOP:
+            *x = (screen_width - *width) / 2;
+            *y = 1;
+            break;
+        case TOAST_BOTTOM:
+        default:
+            *x = (screen_width - *width) / 2;
+            *y = screen_height - *height - 1;
+            break;
+        case TOAST_TOP_RIGHT:
+            *x = screen_width - *width - 2;
+            *y = 1;
+            break;
+        case TOAST_BOTTOM_RIGHT:
+            *x = screen_width - *width - 2;
+            *y = screen_height - *height - 1;
+            break;
+    }
+}
+
 component_t* Toast(ToastConfig config) {
     if (!config.message || !config.is_visible) {
         return NULL;
     }
 
+    update_toast_timer(&config);
+
     component_t* comp = component_create(COMPONENT_TOAST);
     if (!comp) {
         return NULL;
     }
 
-    toast_data_t* data = (toast_data_t*)malloc(sizeof(toast_data_t));
+    toast_data_t* data = component_alloc(sizeof(toast_data_t));
     if (!data) {
         component_free(comp);
         return NULL;
     }
 
-    data->message = strdup(config.message);
+    data->message = component_strdup(config.message);
     if (!data->message) {
-        free(data);
+        component_dealloc(data);
         component_free(comp);
         return NULL;
     }
@@ -1,5 +1,7 @@
 #include "internal/diff.h"
 #include "internal/component.h"
+#include "internal/screen.h"
+#include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
 
@@ -82,11 +84,12 @@ static unsigned int hash_component_data(struct component_t* component) {
             if (data->scroll_offset) {
                 hash = hash_combine(hash, hash_int(*data->scroll_offset));
             }
-            // Hash each item string
-            for (int i = 0; i < data->item_count; i++) {
-                if (data->items[i]) {
-                    hash = hash_combine(hash, hash_string(data->items[i]));
-                }
+            // Hash the items in view; the rest can't affect the output
+            // except through the width, which is compared separately
+            int start, end;
+            list_get_visible_range(data, &start, &end);
+            for (int i = start; i < end; i++) {
+                hash = hash_combine(hash, hash_string(list_get_item(data, i)));
             }
             break;
         }
@@ -122,15 +125,24 @@ static unsigned int hash_component_data(struct component_t* component) {
                     hash = hash_combine(hash, hash_string(data->headers[i]));
                 }
             }
-            // Hash cells (sample first few rows to avoid being too slow)
-            int rows_to_hash = data->row_count < 10 ? data->row_count : 10;
-            for (int r = 0; r < rows_to_hash; r++) {
+            if (data->selected_row) {
+                hash = hash_combine(hash, hash_int(*data->selected_row));
+            }
+            // Hash every cell in view, and only those
+            int start, end;
+            table_get_visible_range(data, &start, &end);
+            hash = hash_combine(hash, hash_int(start));
+            for (int r = start; r < end; r++) {
+                const char** row = table_get_row(data, r);
                 for (int c = 0; c < data->header_count; c++) {
-                    if (data->rows[r] && data->rows[r][c]) {
-                        hash = hash_combine(hash, hash_string(data->rows[r][c]));
+                    if (row && row[c]) {
+                        hash = hash_combine(hash, hash_string(row[c]));
                     }
                 }
             }
+            for (int c = 0; c < data->header_count; c++) {
+                hash = hash_combine(hash, hash_int(data->column_widths[c]));
+            }
             break;
         }
 
@@ -168,6 +180,10 @@ static unsigned int hash_component_data(struct component_t* component) {
             break;
         }
 
+        case COMPONENT_MEMO:
+            // Compared by subtree identity in component_diff_trees()
+            break;
+
         case COMPONENT_VSTACK:
         case COMPONENT_HSTACK:
             // For stacks, hash alignment and spacing if they have data
@@ -212,6 +228,210 @@ unsigned int component_compute_hash(struct component_t* component) {
     return hash;
 }
 
+/**
+ * Check whether any child of either tree carries a key
+ */
+static bool has_keyed_children(struct component_t* old_tree, struct component_t* new_tree) {
+    for (int i = 0; i < old_tree->child_count; i++) {
+        if (old_tree->children[i] && old_tree->children[i]->key) {
+            return true;
+        }
+    }
+    for (int i = 0; i < new_tree->child_count; i++) {
+        if (new_tree->children[i] && new_tree->children[i]->key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Mark matched children that changed relative order as dirty
+ * match[i] is the old index of new child i, or -1. The longest run of
+ * matches whose old indices increase stays in place; everything else has
+ * moved. scratch must hold 2 * count ints.
+ */
+static bool mark_moved_children(struct component_t* new_tree, const int* match, int* scratch) {
+    int count = new_tree->child_count;
+    int* tails = scratch;          // tails[k]: new index ending the best run of length k + 1
+    int* prev = scratch + count;   // prev[i]: new index before i in its run, or -1
+    int length = 0;
+
+    for (int i = 0; i < count; i++) {
+        prev[i] = -1;
+        if (match[i] < 0) {
+            continue;
+        }
+
+        // Binary search for the first run whose tail is not smaller
+        int lo = 0;
+        int hi = length;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (match[tails[mid]] < match[i]) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+
+        if (lo > 0) {
+            prev[i] = tails[lo - 1];
+        }
+        tails[lo] = i;
+        if (lo == length) {
+            length++;
+        }
+    }
+
+    // Walk the longest run back, flagging its members with -2 in prev
+    int i = length > 0 ? tails[length - 1] : -1;
+    while (i >= 0) {
+        int before = prev[i];
+        prev[i] = -2;
+        i = before;
+    }
+
+    bool moved = false;
+    for (i = 0; i < count; i++) {
+        if (match[i] >= 0 && prev[i] != -2) {
+            component_mark_all_dirty(new_tree->children[i]);
+            moved = true;
+        }
+    }
+    return moved;
+}
+
+/**
+ * Diff children by key rather than position
+ * Keyed children pair up with the old child of the same key; unkeyed
+ * children pair up in order with the unkeyed old children. Returns -1 if
+ * scratch memory couldn't be allocated, otherwise whether anything changed.
+ */
+static int diff_keyed_children(struct component_t* old_tree, struct component_t* new_tree) {
+    int old_count = old_tree->child_count;
+    int new_count = new_tree->child_count;
+
+    // Open-addressed table of old keyed children, at most half full
+    int table_size = 4;
+    while (table_size < old_count * 2) {
+        table_size *= 2;
+    }
+
+    int* scratch = malloc((table_size + old_count + new_count * 3) * sizeof(int));
+    if (!scratch) {
+        return -1;
+    }
+    int* table = scratch;                     // Old child index, or -1
+    int* old_used = table + table_size;       // 1 once an old child is matched
+    int* match = old_used + old_count;        // Old index per new child, or -1
+    int* lis_scratch = match + new_count;     // 2 * new_count for mark_moved_children
+
+    for (int i = 0; i < table_size; i++) {
+        table[i] = -1;
+    }
+    for (int j = 0; j < old_count; j++) {
+        old_used[j] = 0;
+        struct component_t* child = old_tree->children[j];
+        if (child && child->key) {
+            unsigned int slot = hash_string(child->key) & (table_size - 1);
+            while (table[slot] >= 0) {
+                slot = (slot + 1) & (table_size - 1);
+            }
+            table[slot] = j;
+        }
+    }
+
+    // Pair up new children with old ones
+    int next_unkeyed = 0;
+    for (int i = 0; i < new_count; i++) {
+        struct component_t* child = new_tree->children[i];
+        match[i] = -1;
+        if (!child) {
+            continue;
+        }
+
+        if (child->key) {
+            unsigned int slot = hash_string(child->key) & (table_size - 1);
+            while (table[slot] >= 0) {
+                int j = table[slot];
+                if (!old_used[j] && strcmp(old_tree->children[j]->key, child->key) == 0) {
+                    match[i] = j;
+                    break;
+                }
+                slot = (slot + 1) & (table_size - 1);
+            }
+        } else {
+            while (next_unkeyed < old_count &&
+                   (!old_tree->children[next_unkeyed] || old_tree->children[next_unkeyed]->key)) {
+                next_unkeyed++;
+            }
+            if (next_unkeyed < old_count) {
+                match[i] = next_unkeyed++;
+            }
+        }
+
+        if (match[i] >= 0) {
+            old_used[match[i]] = 1;
+        }
+    }
+
+    bool has_changes = false;
+    bool reshaped = old_count != new_count;  // Children added, removed or moved
+
+    for (int i = 0; i < new_count; i++) {
+        if (match[i] >= 0) {
+            if (component_diff_trees(old_tree->children[match[i]], new_tree->children[i])) {
+                has_changes = true;
+            }
+        } else {
+            // Inserted
+            component_mark_all_dirty(new_tree->children[i]);
+            reshaped = true;
+        }
+    }
+
+    // Removed children take their animations with them
+    for (int j = 0; j < old_count; j++) {
+        if (!old_used[j]) {
+            component_cancel_animations(old_tree->children[j]);
+            reshaped = true;
+        }
+    }
+
+    if (mark_moved_children(new_tree, match, lis_scratch)) {
+        reshaped = true;
+    }
+
+    free(scratch);
+
+    if (reshaped) {
+        new_tree->dirty = true;
+        has_changes = true;
+    }
+    return has_changes ? 1 : 0;
+}
+
+/**
+ * Add the area a component draws into to the next frame's damage
+ */
+static void damage_paint_area(struct component_t* component) {
+    screen_damage(component->paint_x, component->paint_y,
+                  component->paint_width, component->paint_height);
+}
+
+/**
+ * A dirty component is redrawn where it was and where it is now
+ * Its whole subtree lies within those areas, so dirty descendants add
+ * nothing more.
+ */
+static void damage_if_dirty(struct component_t* old_tree, struct component_t* new_tree) {
+    if (new_tree->dirty) {
+        damage_paint_area(old_tree);
+        damage_paint_area(new_tree);
+    }
+}
+
 bool component_diff_trees(struct component_t* old_tree, struct component_t* new_tree) {
     if (!new_tree) {
         return false;
@@ -220,6 +440,7 @@ bool component_diff_trees(struct component_t* old_tree, struct component_t* new_
     // If no old tree, mark everything as dirty
     if (!old_tree) {
         component_mark_all_dirty(new_tree);
+        damage_paint_area(new_tree);
         return true;
     }
 
@@ -227,12 +448,21 @@ bool component_diff_trees(struct component_t* old_tree, struct component_t* new_
 
     // Check if types differ
     if (old_tree->type != new_tree->type) {
-        new_tree->dirty = true;
+        // The old subtree is replaced; nothing will pick up its animations
+        component_cancel_animations(old_tree);
+        component_mark_all_dirty(new_tree);
+        damage_if_dirty(old_tree, new_tree);
         return true;
     }
 
-    // Compute hashes
-    component_compute_hash(old_tree);
+    // Dirty means this component itself draws differently; changes further
+    // down only make the changed descendants dirty
+    new_tree->dirty = false;
+
+    // The old tree keeps the hash from when it was diffed as the new tree.
+    // Its data can't be rehashed: borrowed strings and state pointers may
+    // have changed since. A tree that was never hashed has hash 0 and is
+    // simply treated as changed.
     component_compute_hash(new_tree);
 
     // Compare hashes
@@ -243,7 +473,10 @@ bool component_diff_trees(struct component_t* old_tree, struct component_t* new_
 
     // Check layout changes (position/size changes need re-render)
     if (old_tree->x != new_tree->x || old_tree->y != new_tree->y ||
-        old_tree->width != new_tree->width || old_tree->height != new_tree->height) {
+        old_tree->width != new_tree->width || old_tree->height != new_tree->height ||
+        old_tree->paint_x != new_tree->paint_x || old_tree->paint_y != new_tree->paint_y ||
+        old_tree->paint_width != new_tree->paint_width ||
+        old_tree->paint_height != new_tree->paint_height) {
         new_tree->dirty = true;
         has_changes = true;
     }
@@ -281,9 +514,23 @@ bool component_diff_trees(struct component_t* old_tree, struct component_t* new_
         }
     }
 
-    // Recursively diff children
-    // For simplicity, if child count changed, mark as dirty
-    if (old_tree->child_count != new_tree->child_count) {
+    // A reused memo subtree is the very same tree as last frame
+    if (new_tree->type == COMPONENT_MEMO && new_tree->child_count > 0 &&
+        old_tree->child_count > 0 && old_tree->children[0] == new_tree->children[0]) {
+        damage_if_dirty(old_tree, new_tree);
+        return has_changes;
+    }
+
+    // Recursively diff children: by key when the children have keys,
+    // otherwise by position
+    int keyed_result = has_keyed_children(old_tree, new_tree) ?
+                       diff_keyed_children(old_tree, new_tree) : -1;
+    if (keyed_result >= 0) {
+        if (keyed_result) {
+            has_changes = true;
+        }
+    } else if (old_tree->child_count != new_tree->child_count) {
+        // For simplicity, if child count changed, mark as dirty
         new_tree->dirty = true;
         has_changes = true;
         // Still diff matching children
@@ -296,6 +543,10 @@ bool component_diff_trees(struct component_t* old_tree, struct component_t* new_
         for (int i = min_children; i < new_tree->child_count; i++) {
             component_mark_all_dirty(new_tree->children[i]);
         }
+        // Removed children take their animations with them
+        for (int i = min_children; i < old_tree->child_count; i++) {
+            component_cancel_animations(old_tree->children[i]);
+        }
     } else {
         // Same child count, diff each child
         for (int i = 0; i < new_tree->child_count; i++) {
@@ -335,10 +586,7 @@ bool component_diff_trees(struct component_t* old_tree, struct component_t* new_
         }
     }
 
-    // If any children changed, parent is dirty (needs re-render for proper layout)
-    if (has_changes && !new_tree->dirty) {
-        new_tree->dirty = true;
-    }
+    damage_if_dirty(old_tree, new_tree);
 
     return has_changes || new_tree->dirty;
 }
@@ -356,6 +604,8 @@ void component_mark_all_dirty(struct component_t* component) {
     }
 
     component->dirty = true;
+    // Hash now so the next frame has something to diff against
+    component_compute_hash(component);
 
     // Recursively mark children
     for (int i = 0; i < component->child_count; i++) {
@@ -1,103 +1,610 @@
+// sigaction() and SIGWINCH are POSIX, not standard C
+#define _POSIX_C_SOURCE 200809L
+#define _DARWIN_C_SOURCE
+
 #include "internal/events.h"
+#include "internal/terminal.h"
+#include "internal/animation.h"
+#include "internal/backend.h"
 #include <unistd.h>
 #include <string.h>
 #include <stdlib.h>
-#include <stdio.h>
-#include <sys/select.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+
+// Self-pipe: a sleeping event_poll() returns when a record is written.
+// Records are smaller than PIPE_BUF, so each write() is atomic and
+// concurrent writers never interleave.
+typedef struct {
+    void (*fn)(void* ctx);  // Callback to run on the UI thread (NULL = just wake up)
+    void* ctx;
+} wake_record_t;
+
+static int wake_pipe[2] = {-1, -1};
+static volatile bool accepting_posts = false;
+
+// Callbacks read from the pipe but not yet returned by event_poll()
+#define POST_BATCH 64
+static wake_record_t posted[POST_BATCH];
+static int posted_head = 0;
+static int posted_count = 0;
+
+static volatile sig_atomic_t resize_pending = 0;
+
+// Raw input not yet parsed, kept when the event queue fills up
+#define INPUT_BUFFER_SIZE 4096  // Power of two
+static unsigned char input_buffer[INPUT_BUFFER_SIZE];
+static size_t input_head = 0;  // Next byte to parse (free-running counters)
+static size_t input_tail = 0;  // Next byte to fill
+
+// Parsed events waiting to be returned by event_poll(), oldest first
+#define EVENT_QUEUE_SIZE 256
+static event_t event_queue[EVENT_QUEUE_SIZE];
+static int queue_head = 0;
+static int queue_count = 0;
+
+// A lone ESC is the Esc key unless more of a sequence follows this quickly
+#define ESC_TIMEOUT_US 25000
+
+// Bracketed paste: the terminal wraps pasted text in these markers
+#define PASTE_END "\033[201~"
+#define PASTE_END_LENGTH 6
+#define PASTE_MAX_LENGTH (1024 * 1024)  // Longer pastes are cut off
+
+#define CSI_MAX_PARAMS 8
 
-bool event_poll(event_t* event) {
-    char buf[32];  // Increased for longer mouse sequences
+typedef enum {
+    PARSE_GROUND,
+    PARSE_ESC,   // After ESC
+    PARSE_CSI,   // After ESC [
+    PARSE_SS3,   // After ESC O
+    PARSE_UTF8,  // Inside a multi-byte UTF-8 character
+    PARSE_PASTE, // Between ESC [ 200 ~ and ESC [ 201 ~
+} parse_state_t;
 
-    // Use select() with timeout to allow periodic wakeups
-    fd_set readfds;
-    FD_ZERO(&readfds);
-    FD_SET(STDIN_FILENO, &readfds);
+// Escape sequence parser; keeps its place across reads
+static struct {
+    parse_state_t state;
+    char prefix;        // Private marker ('<', '?', ...) or 0
+    char intermediate;  // Intermediate byte ('$', ...) or 0
+    int params[CSI_MAX_PARAMS];
+    int param_count;
+    int utf8_remaining;
+    uint64_t last_byte_us;  // When the unfinished sequence last grew
 
-    struct timeval timeout;
-    timeout.tv_sec = 0;
-    timeout.tv_usec = 100000;  // 100ms timeout
+    // Paste being collected
+    char* paste;
+    size_t paste_length;
+    size_t paste_capacity;
+    int paste_end_matched;  // Bytes of PASTE_END seen so far
+} parser = { PARSE_GROUND, 0, 0, {0}, 0, 0, 0, NULL, 0, 0, 0 };
 
-    int ready = select(STDIN_FILENO + 1, &readfds, NULL, NULL, &timeout);
+static struct sigaction original_sigwinch;
+static bool sigwinch_installed = false;
 
-    if (ready <= 0) {
-        // Timeout or error - no event available
-        event->type = EVENT_NONE;
+static void handle_sigwinch(int sig) {
+    (void)sig;
+    resize_pending = 1;
+    event_wake();
+}
+
+static bool set_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL);
+    return flags != -1 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) != -1 &&
+           fcntl(fd, F_SETFD, FD_CLOEXEC) != -1;
+}
+
+static bool write_record(void (*fn)(void* ctx), void* ctx) {
+    if (wake_pipe[1] == -1) {
         return false;
     }
 
-    // Data available, read it
-    ssize_t n = read(STDIN_FILENO, buf, sizeof(buf) - 1);
+    wake_record_t record = { fn, ctx };
+    int saved_errno = errno;
+    ssize_t written = write(wake_pipe[1], &record, sizeof(record));
+    errno = saved_errno;
+    return written == (ssize_t)sizeof(record);
+}
 
+/**
+ * Read the next batch of records from the pipe, keeping the callbacks
+ * Returns false if there was nothing to read
+ */
+static bool read_records(void) {
+    wake_record_t records[POST_BATCH];
+    ssize_t n = read(wake_pipe[0], records, sizeof(records));
     if (n <= 0) {
-        event->type = EVENT_NONE;
         return false;
     }
 
-    buf[n] = '\0';
+    posted_head = 0;
+    posted_count = 0;
+    for (int i = 0; i < (int)(n / (ssize_t)sizeof(wake_record_t)); i++) {
+        if (records[i].fn) {
+            posted[posted_count++] = records[i];
+        }
+    }
+    return true;
+}
 
-    if (n == 1) {
-        event->type = EVENT_KEY;
-        event->data.key.code = (unsigned char)buf[0];
-        return true;
+static bool queue_push(const event_t* event) {
+    if (queue_count >= EVENT_QUEUE_SIZE) {
+        return false;
+    }
+    event_queue[(queue_head + queue_count) % EVENT_QUEUE_SIZE] = *event;
+    queue_count++;
+    return true;
+}
+
+static bool queue_pop(event_t* event) {
+    if (queue_count == 0) {
+        return false;
+    }
+    *event = event_queue[queue_head];
+    queue_head = (queue_head + 1) % EVENT_QUEUE_SIZE;
+    queue_count--;
+    return true;
+}
+
+bool event_init(void) {
+    // The pipe outlives tui_run(): worker threads may still be posting, and
+    // closing it under them could hand the descriptor to an unrelated file
+    if (wake_pipe[0] == -1) {
+        if (pipe(wake_pipe) != 0) {
+            wake_pipe[0] = wake_pipe[1] = -1;
+            return false;
+        }
+        if (!set_nonblocking(wake_pipe[0]) || !set_nonblocking(wake_pipe[1])) {
+            close(wake_pipe[0]);
+            close(wake_pipe[1]);
+            wake_pipe[0] = wake_pipe[1] = -1;
+            return false;
+        }
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handle_sigwinch;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    if (sigaction(SIGWINCH, &action, &original_sigwinch) == 0) {
+        sigwinch_installed = true;
+    }
+
+    accepting_posts = true;
+    return true;
+}
+
+void event_cleanup(void) {
+    accepting_posts = false;
+
+    if (sigwinch_installed) {
+        sigaction(SIGWINCH, &original_sigwinch, NULL);
+        sigwinch_installed = false;
+    }
+
+    // Run what was posted before we stopped accepting, so callers
+    // get to release their contexts
+    while (posted_head < posted_count || (wake_pipe[0] != -1 && read_records())) {
+        while (posted_head < posted_count) {
+            wake_record_t record = posted[posted_head++];
+            record.fn(record.ctx);
+        }
+    }
+
+    // Drop unread input, releasing any pasted text
+    event_t event;
+    while (queue_pop(&event)) {
+        if (event.type == EVENT_PASTE) {
+            free(event.data.paste.text);
+        }
+    }
+    free(parser.paste);
+    parser.paste = NULL;
+    parser.paste_length = 0;
+    parser.paste_capacity = 0;
+    parser.state = PARSE_GROUND;
+    input_head = input_tail = 0;
+}
+
+void event_wake(void) {
+    // A full pipe already has a wakeup pending
+    write_record(NULL, NULL);
+}
+
+bool event_post(void (*fn)(void* ctx), void* ctx) {
+    if (!fn || !accepting_posts) {
+        return false;
+    }
+    return write_record(fn, ctx);
+}
+
+static bool is_motion(const event_t* event) {
+    return event->data.mouse.action == MOUSE_DRAG || event->data.mouse.action == MOUSE_MOVE;
+}
+
+static bool is_wheel(const event_t* event) {
+    return event->data.mouse.button == MOUSE_SCROLL_UP ||
+           event->data.mouse.button == MOUSE_SCROLL_DOWN;
+}
+
+/**
+ * Queue a mouse event, folding it into the previous one where only the
+ * sum matters: a run of movements ends up at the last position, and a run
+ * of wheel steps over one spot becomes a single scroll
+ */
+static void push_mouse(const event_t* event) {
+    if (queue_count > 0) {
+        event_t* last = &event_queue[(queue_head + queue_count - 1) % EVENT_QUEUE_SIZE];
+        if (last->type == EVENT_MOUSE) {
+            if (is_motion(event) && is_motion(last) &&
+                last->data.mouse.button == event->data.mouse.button) {
+                *last = *event;
+                return;
+            }
+
+            if (is_wheel(event) && is_wheel(last) &&
+                last->data.mouse.x == event->data.mouse.x &&
+                last->data.mouse.y == event->data.mouse.y) {
+                last->data.mouse.scroll_delta += event->data.mouse.scroll_delta;
+                last->data.mouse.button = last->data.mouse.scroll_delta < 0 ?
+                                          MOUSE_SCROLL_UP : MOUSE_SCROLL_DOWN;
+                return;
+            }
+        }
+    }
+    queue_push(event);
+}
+
+static void push_key(int code) {
+    event_t event;
+    event.type = EVENT_KEY;
+    event.data.key.code = code;
+    queue_push(&event);
+}
+
+static void paste_append(const char* bytes, size_t length) {
+    if (parser.paste_length + length > PASTE_MAX_LENGTH) {
+        return;
+    }
+
+    // Keep room for the terminator
+    if (parser.paste_length + length + 1 > parser.paste_capacity) {
+        size_t new_capacity = parser.paste_capacity == 0 ? 256 : parser.paste_capacity;
+        while (new_capacity < parser.paste_length + length + 1) {
+            new_capacity *= 2;
+        }
+        char* new_paste = realloc(parser.paste, new_capacity);
+        if (!new_paste) {
+            return;
+        }
+        parser.paste = new_paste;
+        parser.paste_capacity = new_capacity;
+    }
+
+    memcpy(parser.paste + parser.paste_length, bytes, length);
+    parser.paste_length += length;
+}
+
+/**
+ * Queue the collected paste as one event, handing over its buffer
+ */
+static void finish_paste(void) {
+    parser.state = PARSE_GROUND;
+    if (!parser.paste) {
+        return;
+    }
+
+    event_t event;
+    event.type = EVENT_PASTE;
+    event.data.paste.text = parser.paste;
+    event.data.paste.length = parser.paste_length;
+    event.data.paste.text[parser.paste_length] = '\0';
+    if (!queue_push(&event)) {
+        free(parser.paste);
+    }
+
+    parser.paste = NULL;
+    parser.paste_length = 0;
+    parser.paste_capacity = 0;
+}
+
+static void push_arrow(unsigned char final) {
+    switch (final) {
+        case 'A': push_key(KEY_UP); break;
+        case 'B': push_key(KEY_DOWN); break;
+        case 'C': push_key(KEY_RIGHT); break;
+        case 'D': push_key(KEY_LEFT); break;
+        default: break;
+    }
+}
+
+/**
+ * Act on a complete CSI sequence
+ */
+static void csi_dispatch(unsigned char final) {
+    int* params = parser.params;
+
+    if (parser.prefix == '<') {
+        // SGR mouse report: \033[<button;x;y(M|m)
+        if ((final == 'M' || final == 'm') && parser.param_count == 3) {
+            event_t event;
+            event.type = EVENT_MOUSE;
+            event.data.mouse.x = params[1] - 1;  // Convert to 0-based
+            event.data.mouse.y = params[2] - 1;  // Convert to 0-based
+            event.data.mouse.scroll_delta = 0;
+
+            // Bit 5 marks motion; the low bits then name the held button,
+            // or 3 for none. Otherwise M = press, m = release
+            int button = params[0];
+            if (button & 32) {
+                button &= ~32;
+                event.data.mouse.action = (button & 3) == 3 ? MOUSE_MOVE : MOUSE_DRAG;
+            } else {
+                event.data.mouse.action = final == 'M' ? MOUSE_PRESS : MOUSE_RELEASE;
+            }
+            event.data.mouse.button = (mouse_button_t)button;
+
+            if (button == MOUSE_SCROLL_UP) {
+                event.data.mouse.scroll_delta = -1;
+            } else if (button == MOUSE_SCROLL_DOWN) {
+                event.data.mouse.scroll_delta = 1;
+            }
+            push_mouse(&event);
+        }
+        return;
     }
 
-    // Multi-byte sequences (arrow keys, mouse, etc.)
-    if (buf[0] == '\033' && buf[1] == '[') {
-        // SGR Mouse event: \033[<button;x;y(M|m)
-        if (buf[2] == '<') {
-            int button, x, y;
-            char action;
-
-            // Parse: <button;x;yM or <button;x;ym
-            if (sscanf(buf + 3, "%d;%d;%d%c", &button, &x, &y, &action) == 4) {
-                event->type = EVENT_MOUSE;
-                event->data.mouse.button = (mouse_button_t)button;
-                event->data.mouse.x = x - 1;  // Convert to 0-based
-                event->data.mouse.y = y - 1;  // Convert to 0-based
-
-                // M = press, m = release
-                if (action == 'M') {
-                    event->data.mouse.action = MOUSE_PRESS;
-                } else if (action == 'm') {
-                    event->data.mouse.action = MOUSE_RELEASE;
+    if (parser.prefix == '?') {
+        // DECRPM reply to the synchronized update probe: \033[?2026;<state>$y
+        // State 1 (set) or 2 (reset) means supported, 0 or 4 means not
+        if (final == 'y' && parser.intermediate == '$' && parser.param_count == 2 &&
+            params[0] == 2026) {
+            term_set_sync_update_supported(params[1] == 1 || params[1] == 2);
+        }
+        return;
+    }
+
+    if (parser.prefix != 0) {
+        return;
+    }
+
+    if (final == '~') {
+        if (parser.param_count >= 1 && params[0] == 3) {
+            push_key(KEY_DELETE);
+        } else if (parser.param_count >= 1 && params[0] == 200) {
+            // Everything up to the end marker is text, not keys
+            parser.state = PARSE_PASTE;
+            parser.paste_end_matched = 0;
+        }
+        return;
+    }
+
+    // Arrow keys, with or without modifier parameters
+    push_arrow(final);
+}
+
+static void begin_csi(void) {
+    parser.state = PARSE_CSI;
+    parser.prefix = 0;
+    parser.intermediate = 0;
+    parser.param_count = 0;
+    memset(parser.params, 0, sizeof(parser.params));
+}
+
+/**
+ * Feed one input byte to the parser
+ */
+static void parse_byte(unsigned char c) {
+    switch (parser.state) {
+        case PARSE_GROUND:
+            if (c == 0x1B) {
+                parser.state = PARSE_ESC;
+            } else if (c < 0x80) {
+                push_key(c);
+            } else if (c >= 0xC0 && c < 0xF8) {
+                // The key handlers only deal with ASCII; skip the whole
+                // character rather than passing its bytes on as keys
+                parser.state = PARSE_UTF8;
+                parser.utf8_remaining = c >= 0xF0 ? 3 : c >= 0xE0 ? 2 : 1;
+            }
+            break;
+
+        case PARSE_UTF8:
+            if ((c & 0xC0) == 0x80) {
+                if (--parser.utf8_remaining == 0) {
+                    parser.state = PARSE_GROUND;
+                }
+            } else {
+                // Truncated character
+                parser.state = PARSE_GROUND;
+                parse_byte(c);
+            }
+            break;
+
+        case PARSE_ESC:
+            if (c == '[') {
+                begin_csi();
+            } else if (c == 'O') {
+                parser.state = PARSE_SS3;
+            } else if (c == 0x1B) {
+                // Esc pressed twice
+                push_key(KEY_ESC);
+            } else {
+                // Alt+key isn't supported
+                parser.state = PARSE_GROUND;
+            }
+            break;
+
+        case PARSE_PASTE:
+            if (c == (unsigned char)PASTE_END[parser.paste_end_matched]) {
+                if (++parser.paste_end_matched == PASTE_END_LENGTH) {
+                    finish_paste();
+                }
+            } else {
+                // What looked like the end marker was text after all
+                paste_append(PASTE_END, (size_t)parser.paste_end_matched);
+                parser.paste_end_matched = 0;
+                if (c == (unsigned char)PASTE_END[0]) {
+                    parser.paste_end_matched = 1;
                 } else {
-                    event->data.mouse.action = MOUSE_DRAG;
+                    char byte = (char)c;
+                    paste_append(&byte, 1);
                 }
+            }
+            break;
+
+        case PARSE_SS3:
+            // Arrow keys in application cursor mode: \033OA
+            push_arrow(c);
+            parser.state = PARSE_GROUND;
+            break;
 
-                return true;
+        case PARSE_CSI:
+            if (c >= '0' && c <= '9') {
+                if (parser.param_count == 0) {
+                    parser.param_count = 1;
+                }
+                int* param = &parser.params[parser.param_count - 1];
+                if (*param < 100000) {
+                    *param = *param * 10 + (c - '0');
+                }
+            } else if (c == ';') {
+                if (parser.param_count == 0) {
+                    parser.param_count = 1;
+                }
+                if (parser.param_count < CSI_MAX_PARAMS) {
+                    parser.param_count++;
+                }
+            } else if (c >= 0x3C && c <= 0x3F) {
+                parser.prefix = (char)c;
+            } else if (c >= 0x20 && c <= 0x2F) {
+                parser.intermediate = (char)c;
+            } else if (c >= 0x40 && c <= 0x7E) {
+                parser.state = PARSE_GROUND;
+                csi_dispatch(c);  // May start a paste
+            } else if (c == 0x1B) {
+                // Broken sequence; start over
+                parser.state = PARSE_ESC;
+            } else {
+                parser.state = PARSE_GROUND;
             }
+            break;
+    }
+}
+
+/**
+ * Parse buffered input until it runs out or the event queue is full
+ */
+static void parse_input(void) {
+    // A byte produces at most one event
+    while (input_head != input_tail && queue_count < EVENT_QUEUE_SIZE) {
+        parse_byte(input_buffer[input_head % INPUT_BUFFER_SIZE]);
+        input_head++;
+    }
+}
+
+/**
+ * Read whatever input is available into the input buffer
+ */
+static void read_input(void) {
+    size_t used = input_tail - input_head;
+    if (used == INPUT_BUFFER_SIZE) {
+        return;
+    }
+
+    // Fill up to the end of the buffer; a later read wraps around
+    size_t offset = input_tail % INPUT_BUFFER_SIZE;
+    size_t space = INPUT_BUFFER_SIZE - used;
+    if (space > INPUT_BUFFER_SIZE - offset) {
+        space = INPUT_BUFFER_SIZE - offset;
+    }
+
+    ssize_t n = backend_get()->read(input_buffer + offset, space);
+    if (n > 0) {
+        input_tail += (size_t)n;
+        parser.last_byte_us = anim_get_time_us();
+    }
+}
+
+/**
+ * Give up on an unfinished sequence; a lone ESC was the Esc key
+ */
+static void flush_escape(void) {
+    if (parser.state == PARSE_ESC) {
+        push_key(KEY_ESC);
+    }
+    parser.state = PARSE_GROUND;
+}
+
+bool event_poll(event_t* event, int timeout_ms) {
+    event->type = EVENT_NONE;
+
+    if (posted_head < posted_count) {
+        event->type = EVENT_POST;
+        event->data.post.fn = posted[posted_head].fn;
+        event->data.post.ctx = posted[posted_head].ctx;
+        posted_head++;
+        return true;
+    }
+
+    // Input left over from a burst that filled the queue
+    parse_input();
+    if (queue_pop(event)) {
+        return true;
+    }
+
+    // An unfinished sequence only waits so long for the rest of it; pasted
+    // text can take its time
+    bool escape_pending = parser.state == PARSE_ESC || parser.state == PARSE_CSI ||
+                          parser.state == PARSE_SS3;
+    if (escape_pending) {
+        uint64_t elapsed_us = anim_get_time_us() - parser.last_byte_us;
+        if (elapsed_us >= ESC_TIMEOUT_US) {
+            flush_escape();
+            return queue_pop(event);
         }
 
-        // Regular escape sequences (arrow keys, etc.)
-        switch (buf[2]) {
-            case 'A':
-                event->type = EVENT_KEY;
-                event->data.key.code = KEY_UP;
-                return true;
-            case 'B':
-                event->type = EVENT_KEY;
-                event->data.key.code = KEY_DOWN;
-                return true;
-            case 'C':
-                event->type = EVENT_KEY;
-                event->data.key.code = KEY_RIGHT;
-                return true;
-            case 'D':
-                event->type = EVENT_KEY;
-                event->data.key.code = KEY_LEFT;
-                return true;
-            case '3':
-                if (buf[3] == '~') {
-                    event->type = EVENT_KEY;
-                    event->data.key.code = KEY_DELETE;
-                    return true;
-                }
-                break;
-        	default:
-        		break;
+        int escape_ms = (int)((ESC_TIMEOUT_US - elapsed_us + 999) / 1000);
+        if (timeout_ms < 0 || timeout_ms > escape_ms) {
+            timeout_ms = escape_ms;
         }
     }
 
-    event->type = EVENT_NONE;
-    return false;
+    // Sleep until input, a wakeup, or the timeout
+    int ready = backend_get()->wait(wake_pipe[0], timeout_ms);
+
+    if (resize_pending) {
+        resize_pending = 0;
+        event->type = EVENT_RESIZE;
+        return true;
+    }
+
+    if (ready & BACKEND_END) {
+        // The input is gone for good; nothing could end the loop otherwise
+        event->type = EVENT_QUIT;
+        return true;
+    }
+
+    if (ready == 0) {
+        // Timeout or error - no input available
+        return false;
+    }
+
+    if (ready & BACKEND_INPUT) {
+        // Everything read is parsed at once; one read can hold many events
+        read_input();
+        parse_input();
+    }
+
+    if ((ready & BACKEND_WAKE) && read_records() && posted_count > 0) {
+        event->type = EVENT_POST;
+        event->data.post.fn = posted[0].fn;
+        event->data.post.ctx = posted[0].ctx;
+        posted_head = 1;
+        return true;
+    }
+
+    return queue_pop(event);
 }
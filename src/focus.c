@@ -1,29 +1,121 @@
 #include "internal/focus.h"
+#include "internal/memo.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
 
-#define MAX_FOCUSABLE 64
+// Identities are polynomial hashes of the path from the root, so the
+// identity of a node below a memo can be made from the memo's identity
+// and the node's path relative to it
+#define PATH_PRIME 0x100000001b3ULL
+#define KEYED_STEP 0x9e3779b97f4a7c15ULL
 
-static struct component_t* focusable_list[MAX_FOCUSABLE];
-static int focusable_count = 0;
+// Number of component types (COMPONENT_MEMO is the last one)
+#define TYPE_COUNT (COMPONENT_MEMO + 1)
+
+typedef struct {
+    struct component_t* component;
+    uint64_t id;     // Identity, or the path below the memo in a cache
+    uint64_t scale;  // PATH_PRIME to the depth below the memo, in a cache
+} focus_entry_t;
+
+typedef struct {
+    focus_entry_t* items;
+    int count;
+    int capacity;
+} focus_list_t;
+
+struct focus_cache_t {
+    focus_list_t list;
+    bool cacheable;  // False if the subtree has modals, whose state can change
+};
+
+static focus_list_t focusables = {0};
 static int current_focus_index = -1;
-static int saved_focus_index = -1;  // Save focus before modal opens
 
-static struct component_t* find_open_modal(struct component_t* component) {
-    if (!component) {
-        return NULL;
+// Index of every identity in focusables, open addressed (-1 = empty)
+static int* id_table = NULL;
+static int id_table_size = 0;
+
+// Focus before a modal opened, restored when it closes
+static bool has_saved_focus = false;
+static uint64_t saved_focus_id = 0;
+static int saved_focus_index = -1;
+
+// Focus after the last build
+static bool has_built_focus = false;
+static uint64_t built_focus_id = 0;
+
+static uint64_t mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+/**
+ * Path step for a child: its key, or its type and position among the
+ * unkeyed siblings of the same type
+ */
+static uint64_t child_step(struct component_t* child, int* ordinals) {
+    if (child->key) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (const char* p = child->key; *p; p++) {
+            hash = (hash ^ (unsigned char)*p) * PATH_PRIME;
+        }
+        return mix64(hash ^ KEYED_STEP);
     }
 
-    if (component->type == COMPONENT_MODAL) {
-        modal_data_t* data = (modal_data_t*)component->data;
-        if (data && data->is_open && *data->is_open) {
-            return component;
+    return mix64(((uint64_t)child->type << 32) | (uint32_t)ordinals[child->type]++);
+}
+
+static bool list_push(focus_list_t* list, struct component_t* component,
+                      uint64_t id, uint64_t scale) {
+    if (list->count >= list->capacity) {
+        int new_capacity = list->capacity == 0 ? 16 : list->capacity * 2;
+        focus_entry_t* new_items = realloc(list->items, new_capacity * sizeof(focus_entry_t));
+        if (!new_items) {
+            return false;
         }
+        list->items = new_items;
+        list->capacity = new_capacity;
+    }
+
+    focus_entry_t* entry = &list->items[list->count++];
+    entry->component = component;
+    entry->id = id;
+    entry->scale = scale;
+    return true;
+}
+
+static bool is_open_modal(struct component_t* component) {
+    if (component->type != COMPONENT_MODAL) {
+        return false;
+    }
+    modal_data_t* data = (modal_data_t*)component->data;
+    return data && data->is_open && *data->is_open;
+}
+
+/**
+ * Find the first open modal, along with the identity of its content
+ */
+static struct component_t* find_open_modal(struct component_t* component, uint64_t id,
+                                           uint64_t* content_id) {
+    if (is_open_modal(component)) {
+        *content_id = id * PATH_PRIME + KEYED_STEP;
+        return component;
     }
 
+    int ordinals[TYPE_COUNT] = {0};
     for (int i = 0; i < component->child_count; i++) {
-        struct component_t* modal = find_open_modal(component->children[i]);
+        struct component_t* child = component->children[i];
+        if (!child) {
+            continue;
+        }
+        uint64_t step = child_step(child, ordinals);
+        struct component_t* modal = find_open_modal(child, id * PATH_PRIME + step, content_id);
         if (modal) {
             return modal;
         }
@@ -32,134 +124,250 @@ static struct component_t* find_open_modal(struct component_t* component) {
     return NULL;
 }
 
-static void build_focusable_list_recursive(struct component_t* component) {
-    if (!component) {
-        return;
-    }
+static focus_cache_t* build_cache(struct component_t* memo);
 
-    if (component->focusable && focusable_count < MAX_FOCUSABLE) {
-        component->focus_index = focusable_count;
-        focusable_list[focusable_count++] = component;
+/**
+ * Collect the focusables of a subtree into a list
+ * cache is the cache being built, or NULL when filling the registry
+ */
+static void collect(focus_list_t* list, struct component_t* component,
+                    uint64_t id, uint64_t scale, focus_cache_t* cache) {
+    if (component->focusable && !list_push(list, component, id, scale) && cache) {
+        cache->cacheable = false;
     }
 
     // For modals, only traverse the content, not other children
     if (component->type == COMPONENT_MODAL) {
+        if (cache) {
+            cache->cacheable = false;
+        }
         modal_data_t* data = (modal_data_t*)component->data;
-        if (data && data->is_open && *data->is_open && data->content) {
-            build_focusable_list_recursive(data->content);
+        if (is_open_modal(component) && data->content) {
+            collect(list, data->content, id * PATH_PRIME + KEYED_STEP, scale * PATH_PRIME, cache);
         }
         return;
     }
 
+    // A memoized subtree only changes when it is rebuilt, and that drops its
+    // cache, so its focusables can be copied instead of walking it again
+    if (component->type == COMPONENT_MEMO && !cache) {
+        memo_entry_t* entry = ((memo_data_t*)component->data)->entry;
+        if (entry && !entry->focus_cache) {
+            entry->focus_cache = build_cache(component);
+        }
+        if (entry && entry->focus_cache && entry->focus_cache->cacheable) {
+            focus_list_t* cached = &entry->focus_cache->list;
+            for (int i = 0; i < cached->count; i++) {
+                focus_entry_t* item = &cached->items[i];
+                list_push(list, item->component, id * item->scale + item->id, scale * item->scale);
+            }
+            return;
+        }
+    }
+
+    int ordinals[TYPE_COUNT] = {0};
     for (int i = 0; i < component->child_count; i++) {
-        build_focusable_list_recursive(component->children[i]);
+        struct component_t* child = component->children[i];
+        if (!child) {
+            continue;
+        }
+        uint64_t step = child_step(child, ordinals);
+        collect(list, child, id * PATH_PRIME + step, scale * PATH_PRIME, cache);
+    }
+}
+
+static focus_cache_t* build_cache(struct component_t* memo) {
+    focus_cache_t* cache = calloc(1, sizeof(focus_cache_t));
+    if (!cache) {
+        return NULL;
+    }
+
+    // Paths are relative to the memo: id 0 at depth 0
+    cache->cacheable = true;
+    collect(&cache->list, memo, 0, 1, cache);
+    return cache;
+}
+
+void focus_cache_free(focus_cache_t* cache) {
+    if (cache) {
+        free(cache->list.items);
+        free(cache);
     }
 }
 
-void focus_build_list(struct component_t* root) {
-    int prev_focus = current_focus_index;
+/**
+ * Index the registry by identity
+ * Returns false if the table can't be allocated
+ */
+static bool index_ids(void) {
+    int size = id_table_size > 0 ? id_table_size : 64;
+    while (size < focusables.count * 2) {
+        size *= 2;
+    }
+    if (size != id_table_size) {
+        int* new_table = realloc(id_table, size * sizeof(int));
+        if (!new_table) {
+            return false;
+        }
+        id_table = new_table;
+        id_table_size = size;
+    }
+
+    for (int i = 0; i < id_table_size; i++) {
+        id_table[i] = -1;
+    }
+
+    for (int i = 0; i < focusables.count; i++) {
+        uint64_t id = focusables.items[i].id;
+        int slot = (int)(id & (uint64_t)(id_table_size - 1));
+        while (id_table[slot] != -1) {
+            if (focusables.items[id_table[slot]].id == id) {
+                break;  // Duplicate identity; the first one keeps it
+            }
+            slot = (slot + 1) & (id_table_size - 1);
+        }
+        if (id_table[slot] == -1) {
+            id_table[slot] = i;
+        }
+    }
+    return true;
+}
+
+static int find_id(uint64_t id) {
+    if (id_table_size == 0) {
+        return -1;
+    }
+
+    int slot = (int)(id & (uint64_t)(id_table_size - 1));
+    while (id_table[slot] != -1) {
+        if (focusables.items[id_table[slot]].id == id) {
+            return id_table[slot];
+        }
+        slot = (slot + 1) & (id_table_size - 1);
+    }
+    return -1;
+}
+
+bool focus_build_list(struct component_t* root) {
+    bool had_focus = current_focus_index >= 0;
+    uint64_t prev_id = had_focus ? focusables.items[current_focus_index].id : 0;
+    int prev_index = current_focus_index;
 
     // Check if there's an open modal - if so, only collect focus from it
-    struct component_t* open_modal = find_open_modal(root);
+    uint64_t content_id = 0;
+    struct component_t* open_modal = root ? find_open_modal(root, 0, &content_id) : NULL;
 
     if (open_modal) {
         // Modal is open - save current focus if not already saved
-        if (saved_focus_index == -1 && prev_focus >= 0) {
-            saved_focus_index = prev_focus;
-        }
-    } else {
-        // No modal - try to restore saved focus
-        if (saved_focus_index >= 0) {
-            prev_focus = saved_focus_index;
-            saved_focus_index = -1;  // Clear saved focus
+        if (!has_saved_focus && had_focus) {
+            has_saved_focus = true;
+            saved_focus_id = prev_id;
+            saved_focus_index = prev_index;
         }
+    } else if (has_saved_focus) {
+        // No modal - restore saved focus
+        had_focus = true;
+        prev_id = saved_focus_id;
+        prev_index = saved_focus_index;
+        has_saved_focus = false;
+    }
+
+    // Nodes can outlive a frame (memoized subtrees), so drop the old focus
+    // flags rather than relying on fresh nodes starting unfocused
+    for (int i = 0; i < focusables.count; i++) {
+        focusables.items[i].component->focused = false;
     }
 
-    focus_clear();
+    focusables.count = 0;
+    current_focus_index = -1;
 
     if (open_modal) {
         modal_data_t* data = (modal_data_t*)open_modal->data;
-        if (data && data->content) {
-            build_focusable_list_recursive(data->content);
+        if (data->content) {
+            collect(&focusables, data->content, content_id, 1, NULL);
         }
-    } else {
-        build_focusable_list_recursive(root);
+    } else if (root) {
+        collect(&focusables, root, 0, 1, NULL);
+    }
+
+    for (int i = 0; i < focusables.count; i++) {
+        focusables.items[i].component->focus_index = i;
     }
 
-    if (focusable_count > 0) {
-        if (prev_focus >= 0 && prev_focus < focusable_count) {
-            current_focus_index = prev_focus;
-        } else {
-            current_focus_index = 0;
+    if (focusables.count > 0) {
+        // Follow the focused component; if it's gone, keep the position
+        int index = had_focus && index_ids() ? find_id(prev_id) : -1;
+        if (index < 0) {
+            index = prev_index >= 0 && prev_index < focusables.count ? prev_index : 0;
         }
-        focusable_list[current_focus_index]->focused = true;
+        current_focus_index = index;
+        focusables.items[index].component->focused = true;
     }
+
+    bool has_focus = current_focus_index >= 0;
+    uint64_t focus_id = has_focus ? focusables.items[current_focus_index].id : 0;
+    bool moved = has_focus != has_built_focus || focus_id != built_focus_id;
+    has_built_focus = has_focus;
+    built_focus_id = focus_id;
+    return moved;
 }
 
-bool focus_next(void) {
-    if (focusable_count == 0) {
-        return false;
+static void move_focus(int index) {
+    if (current_focus_index >= 0) {
+        focusables.items[current_focus_index].component->focused = false;
     }
+    current_focus_index = index;
+    focusables.items[index].component->focused = true;
+}
 
-    if (current_focus_index >= 0) {
-        focusable_list[current_focus_index]->focused = false;
+bool focus_next(void) {
+    if (focusables.count == 0) {
+        return false;
     }
 
-    current_focus_index = (current_focus_index + 1) % focusable_count;
-    focusable_list[current_focus_index]->focused = true;
+    move_focus((current_focus_index + 1) % focusables.count);
     return true;
 }
 
 bool focus_prev(void) {
-    if (focusable_count == 0) {
+    if (focusables.count == 0) {
         return false;
     }
 
-    if (current_focus_index >= 0) {
-        focusable_list[current_focus_index]->focused = false;
-    }
-
-    current_focus_index--;
-    if (current_focus_index < 0) {
-        current_focus_index = focusable_count - 1;
-    }
-
-    focusable_list[current_focus_index]->focused = true;
+    move_focus(current_focus_index > 0 ? current_focus_index - 1 : focusables.count - 1);
     return true;
 }
 
 struct component_t* focus_get_current(void) {
-    if (current_focus_index >= 0 && current_focus_index < focusable_count) {
-        return focusable_list[current_focus_index];
+    if (current_focus_index >= 0 && current_focus_index < focusables.count) {
+        return focusables.items[current_focus_index].component;
     }
     return NULL;
 }
 
 void focus_clear(void) {
-    memset(focusable_list, 0, sizeof(focusable_list));
-    focusable_count = 0;
+    free(focusables.items);
+    focusables = (focus_list_t){0};
+    free(id_table);
+    id_table = NULL;
+    id_table_size = 0;
     current_focus_index = -1;
+    has_saved_focus = false;
+    has_built_focus = false;
 }
 
 bool focus_set(struct component_t* component) {
-    if (!component || focusable_count == 0) {
+    if (!component) {
         return false;
     }
 
-    // Find the component in the focusable list
-    for (int i = 0; i < focusable_count; i++) {
-        if (focusable_list[i] == component) {
-            // Clear old focus
-            if (current_focus_index >= 0 && current_focus_index < focusable_count) {
-                focusable_list[current_focus_index]->focused = false;
-            }
-
-            // Set new focus
-            current_focus_index = i;
-            focusable_list[current_focus_index]->focused = true;
-            return true;
-        }
+    // focus_index is only trusted if the registry agrees
+    int index = component->focus_index;
+    if (index < 0 || index >= focusables.count ||
+        focusables.items[index].component != component) {
+        return false;
     }
 
-    return false;
+    move_focus(index);
+    return true;
 }
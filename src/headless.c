@@ -0,0 +1,588 @@
+// select() is POSIX, not standard C
+#define _POSIX_C_SOURCE 200809L
+#define _DARWIN_C_SOURCE
+
+#include "../include/intuitive.h"
+#include "internal/backend.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/select.h>
+
+/**
+ * Headless backend: a terminal emulated in memory
+ * Output is interpreted into a grid of cells the way a terminal would
+ * (covering the sequences terminal.c emits), input is scripted with
+ * tui_headless_input(), and the clock only moves when the event loop
+ * sleeps, so the same script always produces the same frames.
+ */
+
+typedef struct {
+    char glyph[4];      // UTF-8 bytes of the character (not NUL-terminated)
+    uint8_t glyph_len;  // Number of bytes used in glyph
+    uint8_t fg;         // color_t
+    uint8_t bg;         // color_t
+    uint8_t style;      // style_t flags
+} headless_cell_t;
+
+// Virtual time starts here rather than at 0, which callers use as "unset"
+#define HEADLESS_START_US 1000000
+
+#define CSI_MAX_PARAMS 8
+
+typedef enum {
+    OUTPUT_GROUND,
+    OUTPUT_ESC,   // After ESC
+    OUTPUT_CSI,   // After ESC [
+    OUTPUT_UTF8,  // Inside a multi-byte UTF-8 character
+} output_state_t;
+
+// The emulated terminal
+static struct {
+    headless_cell_t* cells;
+    int width;
+    int height;
+    int cursor_x;
+    int cursor_y;
+    bool wrap_pending;   // The last column was written; the next glyph wraps
+    int scroll_top;      // Scroll region rows (inclusive)
+    int scroll_bottom;
+    color_t fg;          // Current pen
+    color_t bg;
+    style_t style;
+    char last_glyph[4];  // Most recent glyph printed, for REP
+    int last_glyph_len;
+
+    // Output parser; keeps its place across writes
+    output_state_t state;
+    char prefix;         // Private marker ('?', ...) or 0
+    char intermediate;   // Intermediate byte ('$', ...) or 0
+    int params[CSI_MAX_PARAMS];
+    int param_count;
+    char utf8[4];
+    int utf8_length;
+    int utf8_remaining;
+} term = {0};
+
+// Scripted input; chunk i holds the bytes before chunks[i].end and
+// arrives at chunks[i].time_us
+typedef struct {
+    uint64_t time_us;
+    size_t end;
+} input_chunk_t;
+
+static struct {
+    unsigned char* bytes;
+    size_t length;
+    size_t capacity;
+    input_chunk_t* chunks;
+    int chunk_count;
+    int chunk_capacity;
+    size_t read_pos;  // Next byte to hand out
+    int next_chunk;   // First chunk not read completely
+} input = {0};
+
+static uint64_t clock_us = HEADLESS_START_US;
+
+/* ========== Output ========== */
+
+static headless_cell_t* cell_at(int x, int y) {
+    return &term.cells[y * term.width + x];
+}
+
+/**
+ * Blank cells [from, to) of row y in the current background color
+ */
+static void erase_cells(int y, int from, int to) {
+    if (from < 0) from = 0;
+    if (to > term.width) to = term.width;
+    for (int x = from; x < to; x++) {
+        headless_cell_t* cell = cell_at(x, y);
+        cell->glyph[0] = ' ';
+        cell->glyph_len = 1;
+        cell->fg = COLOR_DEFAULT;
+        cell->bg = (uint8_t)term.bg;
+        cell->style = STYLE_NONE;
+    }
+}
+
+/**
+ * Move rows top..bottom (inclusive) up by amount, or down if negative
+ */
+static void scroll_rows(int top, int bottom, int amount) {
+    int rows = bottom - top + 1;
+    int distance = amount > 0 ? amount : -amount;
+    if (distance > rows) {
+        distance = rows;
+    }
+
+    size_t row_size = (size_t)term.width * sizeof(headless_cell_t);
+    if (amount > 0) {
+        memmove(cell_at(0, top), cell_at(0, top + distance), (size_t)(rows - distance) * row_size);
+        for (int y = bottom - distance + 1; y <= bottom; y++) {
+            erase_cells(y, 0, term.width);
+        }
+    } else {
+        memmove(cell_at(0, top + distance), cell_at(0, top), (size_t)(rows - distance) * row_size);
+        for (int y = top; y < top + distance; y++) {
+            erase_cells(y, 0, term.width);
+        }
+    }
+}
+
+static void line_feed(void) {
+    if (term.cursor_y == term.scroll_bottom) {
+        scroll_rows(term.scroll_top, term.scroll_bottom, 1);
+    } else if (term.cursor_y < term.height - 1) {
+        term.cursor_y++;
+    }
+}
+
+static void print_glyph(const char* glyph, int length) {
+    if (term.wrap_pending) {
+        term.wrap_pending = false;
+        term.cursor_x = 0;
+        line_feed();
+    }
+
+    headless_cell_t* cell = cell_at(term.cursor_x, term.cursor_y);
+    memcpy(cell->glyph, glyph, (size_t)length);
+    cell->glyph_len = (uint8_t)length;
+    cell->fg = (uint8_t)term.fg;
+    cell->bg = (uint8_t)term.bg;
+    cell->style = (uint8_t)term.style;
+
+    memcpy(term.last_glyph, glyph, (size_t)length);
+    term.last_glyph_len = length;
+
+    // At the right margin the cursor stays put until the next glyph
+    if (term.cursor_x == term.width - 1) {
+        term.wrap_pending = true;
+    } else {
+        term.cursor_x++;
+    }
+}
+
+/**
+ * Parameter i of the current sequence; missing and zero ones are default_value
+ */
+static int param(int i, int default_value) {
+    return i < term.param_count && term.params[i] > 0 ? term.params[i] : default_value;
+}
+
+static int clamp(int value, int min, int max) {
+    return value < min ? min : (value > max ? max : value);
+}
+
+static void set_graphics(void) {
+    if (term.param_count == 0) {
+        term.param_count = 1;
+        term.params[0] = 0;
+    }
+
+    for (int i = 0; i < term.param_count; i++) {
+        int p = term.params[i];
+        if (p == 0) {
+            term.fg = COLOR_DEFAULT;
+            term.bg = COLOR_DEFAULT;
+            term.style = STYLE_NONE;
+        } else if (p == 1) {
+            term.style |= STYLE_BOLD;
+        } else if (p == 4) {
+            term.style |= STYLE_UNDERLINE;
+        } else if (p == 22) {
+            term.style &= ~STYLE_BOLD;
+        } else if (p == 24) {
+            term.style &= ~STYLE_UNDERLINE;
+        } else if (p >= 30 && p <= 37) {
+            term.fg = (color_t)(COLOR_BLACK + p - 30);
+        } else if (p == 39) {
+            term.fg = COLOR_DEFAULT;
+        } else if (p >= 40 && p <= 47) {
+            term.bg = (color_t)(COLOR_BLACK + p - 40);
+        } else if (p == 49) {
+            term.bg = COLOR_DEFAULT;
+        } else if (p >= 90 && p <= 97) {
+            term.fg = (color_t)(COLOR_BRIGHT_BLACK + p - 90);
+        } else if (p >= 100 && p <= 107) {
+            term.bg = (color_t)(COLOR_BRIGHT_BLACK + p - 100);
+        }
+    }
+}
+
+static void csi_dispatch(unsigned char final) {
+    // Mode switches and queries don't change the grid
+    if (term.prefix || term.intermediate) {
+        return;
+    }
+
+    int n = param(0, 1);
+    switch (final) {
+        case 'H':  // CUP
+        case 'f':
+            term.cursor_y = clamp(param(0, 1) - 1, 0, term.height - 1);
+            term.cursor_x = clamp(param(1, 1) - 1, 0, term.width - 1);
+            break;
+        case 'A':  // CUU
+            term.cursor_y = clamp(term.cursor_y - n, 0, term.height - 1);
+            break;
+        case 'B':  // CUD
+            term.cursor_y = clamp(term.cursor_y + n, 0, term.height - 1);
+            break;
+        case 'C':  // CUF
+            term.cursor_x = clamp(term.cursor_x + n, 0, term.width - 1);
+            break;
+        case 'D':  // CUB
+            term.cursor_x = clamp(term.cursor_x - n, 0, term.width - 1);
+            break;
+        case 'J': {  // ED
+            int mode = param(0, 0);
+            int from = mode == 0 ? term.cursor_y + 1 : 0;
+            int to = mode == 1 ? term.cursor_y : term.height;
+            for (int y = from; y < to; y++) {
+                erase_cells(y, 0, term.width);
+            }
+            if (mode == 0) {
+                erase_cells(term.cursor_y, term.cursor_x, term.width);
+            } else if (mode == 1) {
+                erase_cells(term.cursor_y, 0, term.cursor_x + 1);
+            }
+            return;  // Leaves the pending wrap alone
+        }
+        case 'K': {  // EL
+            int mode = param(0, 0);
+            erase_cells(term.cursor_y, mode == 0 ? term.cursor_x : 0,
+                        mode == 1 ? term.cursor_x + 1 : term.width);
+            break;
+        }
+        case 'X':  // ECH
+            erase_cells(term.cursor_y, term.cursor_x, term.cursor_x + n);
+            break;
+        case 'b':  // REP
+            for (int i = 0; i < n && term.last_glyph_len > 0; i++) {
+                print_glyph(term.last_glyph, term.last_glyph_len);
+            }
+            return;
+        case 'm':  // SGR
+            set_graphics();
+            return;
+        case 'r': {  // DECSTBM; homes the cursor
+            int top = param(0, 1) - 1;
+            int bottom = param(1, term.height) - 1;
+            if (top < bottom && bottom < term.height) {
+                term.scroll_top = top;
+                term.scroll_bottom = bottom;
+            }
+            term.cursor_x = 0;
+            term.cursor_y = 0;
+            break;
+        }
+        case 'S':  // SU
+            scroll_rows(term.scroll_top, term.scroll_bottom, n);
+            return;
+        case 'T':  // SD
+            scroll_rows(term.scroll_top, term.scroll_bottom, -n);
+            return;
+        default:
+            return;
+    }
+    term.wrap_pending = false;
+}
+
+static void output_byte(unsigned char c) {
+    switch (term.state) {
+        case OUTPUT_GROUND:
+            if (c == 0x1B) {
+                term.state = OUTPUT_ESC;
+            } else if (c == '\r') {
+                term.cursor_x = 0;
+                term.wrap_pending = false;
+            } else if (c == '\n') {
+                line_feed();
+                term.wrap_pending = false;
+            } else if (c == '\b') {
+                if (term.cursor_x > 0) {
+                    term.cursor_x--;
+                }
+                term.wrap_pending = false;
+            } else if (c >= 0x20 && c < 0x7F) {
+                char glyph = (char)c;
+                print_glyph(&glyph, 1);
+            } else if (c >= 0xC0 && c <= 0xF7) {
+                term.utf8[0] = (char)c;
+                term.utf8_length = 1;
+                term.utf8_remaining = c >= 0xF0 ? 3 : (c >= 0xE0 ? 2 : 1);
+                term.state = OUTPUT_UTF8;
+            }
+            break;
+
+        case OUTPUT_ESC:
+            if (c == '[') {
+                term.prefix = 0;
+                term.intermediate = 0;
+                term.param_count = 0;
+                memset(term.params, 0, sizeof(term.params));
+                term.state = OUTPUT_CSI;
+            } else {
+                term.state = OUTPUT_GROUND;
+            }
+            break;
+
+        case OUTPUT_CSI:
+            if (c >= '0' && c <= '9') {
+                if (term.param_count == 0) {
+                    term.param_count = 1;
+                }
+                int* p = &term.params[term.param_count - 1];
+                if (*p < 100000) {
+                    *p = *p * 10 + (c - '0');
+                }
+            } else if (c == ';') {
+                if (term.param_count == 0) {
+                    term.param_count = 1;
+                }
+                if (term.param_count < CSI_MAX_PARAMS) {
+                    term.param_count++;
+                }
+            } else if (c >= 0x3C && c <= 0x3F) {
+                term.prefix = (char)c;
+            } else if (c >= 0x20 && c <= 0x2F) {
+                term.intermediate = (char)c;
+            } else if (c >= 0x40 && c <= 0x7E) {
+                term.state = OUTPUT_GROUND;
+                csi_dispatch(c);
+            } else {
+                term.state = OUTPUT_GROUND;
+            }
+            break;
+
+        case OUTPUT_UTF8:
+            if ((c & 0xC0) != 0x80) {
+                // Broken character; drop it and take this byte afresh
+                term.state = OUTPUT_GROUND;
+                output_byte(c);
+                break;
+            }
+            term.utf8[term.utf8_length++] = (char)c;
+            if (--term.utf8_remaining == 0) {
+                term.state = OUTPUT_GROUND;
+                print_glyph(term.utf8, term.utf8_length);
+            }
+            break;
+    }
+}
+
+/* ========== Input ========== */
+
+/**
+ * End of the input that has arrived by now
+ */
+static size_t input_due_end(void) {
+    size_t end = input.read_pos;
+    for (int i = input.next_chunk; i < input.chunk_count && input.chunks[i].time_us <= clock_us; i++) {
+        end = input.chunks[i].end;
+    }
+    return end;
+}
+
+static bool wake_fd_readable(int wake_fd) {
+    if (wake_fd == -1) {
+        return false;
+    }
+
+    fd_set readfds;
+    FD_ZERO(&readfds);
+    FD_SET(wake_fd, &readfds);
+    struct timeval timeout = {0, 0};
+    return select(wake_fd + 1, &readfds, NULL, NULL, &timeout) > 0;
+}
+
+/* ========== Backend ========== */
+
+static bool headless_init(void) {
+    term.cursor_x = 0;
+    term.cursor_y = 0;
+    term.wrap_pending = false;
+    term.scroll_top = 0;
+    term.scroll_bottom = term.height - 1;
+    term.fg = COLOR_DEFAULT;
+    term.bg = COLOR_DEFAULT;
+    term.style = STYLE_NONE;
+    term.last_glyph_len = 0;
+    term.state = OUTPUT_GROUND;
+    for (int y = 0; y < term.height; y++) {
+        erase_cells(y, 0, term.width);
+    }
+    return term.cells != NULL;
+}
+
+static void headless_cleanup(void) {
+    // The grid keeps the last frame for inspection
+}
+
+static ssize_t headless_write(const char* data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        output_byte((unsigned char)data[i]);
+    }
+    return (ssize_t)len;
+}
+
+static bool headless_get_size(int* width, int* height) {
+    *width = term.width;
+    *height = term.height;
+    return true;
+}
+
+static int headless_wait(int wake_fd, int timeout_ms) {
+    int ready = wake_fd_readable(wake_fd) ? BACKEND_WAKE : 0;
+    if (input_due_end() > input.read_pos) {
+        return ready | BACKEND_INPUT;
+    }
+    if (ready) {
+        return ready;
+    }
+
+    // Nothing yet: skip ahead to the next input or to the timeout
+    bool pending = input.next_chunk < input.chunk_count;
+    if (!pending && timeout_ms < 0) {
+        return BACKEND_END;
+    }
+
+    uint64_t timeout_end = clock_us + (uint64_t)(timeout_ms > 0 ? timeout_ms : 0) * 1000;
+    if (pending && (timeout_ms < 0 || input.chunks[input.next_chunk].time_us <= timeout_end)) {
+        if (input.chunks[input.next_chunk].time_us > clock_us) {
+            clock_us = input.chunks[input.next_chunk].time_us;
+        }
+        return BACKEND_INPUT;
+    }
+
+    clock_us = timeout_end;
+    return 0;
+}
+
+static ssize_t headless_read(unsigned char* buffer, size_t size) {
+    size_t available = input_due_end() - input.read_pos;
+    if (size > available) {
+        size = available;
+    }
+    memcpy(buffer, input.bytes + input.read_pos, size);
+    input.read_pos += size;
+
+    while (input.next_chunk < input.chunk_count &&
+           input.chunks[input.next_chunk].end <= input.read_pos) {
+        input.next_chunk++;
+    }
+
+    // Start over once everything has been read
+    if (input.read_pos == input.length) {
+        input.length = 0;
+        input.read_pos = 0;
+        input.chunk_count = 0;
+        input.next_chunk = 0;
+    }
+    return (ssize_t)size;
+}
+
+static uint64_t headless_now_us(void) {
+    return clock_us;
+}
+
+static bool headless_supports_repeat(void) {
+    return true;
+}
+
+const backend_t backend_headless = {
+    headless_init,
+    headless_cleanup,
+    headless_write,
+    headless_get_size,
+    headless_wait,
+    headless_read,
+    headless_now_us,
+    headless_supports_repeat,
+};
+
+/* ========== Public API ========== */
+
+bool tui_use_headless(int width, int height) {
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+
+    headless_cell_t* cells = calloc((size_t)width * (size_t)height, sizeof(headless_cell_t));
+    if (!cells) {
+        return false;
+    }
+    free(term.cells);
+    term.cells = cells;
+    term.width = width;
+    term.height = height;
+    headless_init();
+
+    backend_set(&backend_headless);
+    return true;
+}
+
+bool tui_headless_input(int delay_ms, const char* bytes, size_t length) {
+    if (!bytes || length == 0 || delay_ms < 0) {
+        return false;
+    }
+
+    if (input.length + length > input.capacity) {
+        size_t new_capacity = input.capacity == 0 ? 256 : input.capacity;
+        while (new_capacity < input.length + length) {
+            new_capacity *= 2;
+        }
+        unsigned char* new_bytes = realloc(input.bytes, new_capacity);
+        if (!new_bytes) {
+            return false;
+        }
+        input.bytes = new_bytes;
+        input.capacity = new_capacity;
+    }
+
+    if (input.chunk_count == input.chunk_capacity) {
+        int new_capacity = input.chunk_capacity == 0 ? 16 : input.chunk_capacity * 2;
+        input_chunk_t* new_chunks = realloc(input.chunks, (size_t)new_capacity * sizeof(input_chunk_t));
+        if (!new_chunks) {
+            return false;
+        }
+        input.chunks = new_chunks;
+        input.chunk_capacity = new_capacity;
+    }
+
+    // Chunks arrive in order, each delay_ms after the one before it
+    uint64_t after = clock_us;
+    if (input.chunk_count > 0 && input.chunks[input.chunk_count - 1].time_us > after) {
+        after = input.chunks[input.chunk_count - 1].time_us;
+    }
+
+    memcpy(input.bytes + input.length, bytes, length);
+    input.length += length;
+    input.chunks[input.chunk_count].time_us = after + (uint64_t)delay_ms * 1000;
+    input.chunks[input.chunk_count].end = input.length;
+    input.chunk_count++;
+    return true;
+}
+
+bool tui_headless_get_cell(int x, int y, tui_cell_t* cell) {
+    if (!cell || !term.cells || x < 0 || y < 0 || x >= term.width || y >= term.height) {
+        return false;
+    }
+
+    const headless_cell_t* source = cell_at(x, y);
+    memcpy(cell->glyph, source->glyph, source->glyph_len);
+    cell->glyph[source->glyph_len] = '\0';
+    cell->fg = (color_t)source->fg;
+    cell->bg = (color_t)source->bg;
+    cell->style = (style_t)source->style;
+    return true;
+}
+
+bool tui_headless_get_cursor(int* x, int* y) {
+    if (!x || !y || !term.cells) {
+        return false;
+    }
+    *x = term.cursor_x;
+    *y = term.cursor_y;
+    return true;
+}
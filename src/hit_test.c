@@ -0,0 +1,201 @@
+#include "internal/hit_test.h"
+#include <stdlib.h>
+
+static struct component_t* tree = NULL;
+static int tree_width = 0;
+static int tree_height = 0;
+
+// Top-most component per screen cell, row-major
+static struct component_t** grid = NULL;
+static size_t grid_capacity = 0;
+static bool grid_valid = false;
+
+// While the grid is built: per row, one more slot than cells, each slot
+// leading to the nearest cell at or right of it that's still unclaimed.
+// Union-find links, so claimed runs are skipped instead of rescanned.
+static int* next_free = NULL;
+static size_t next_free_capacity = 0;
+
+// Every modal in the tree, in tree order; whether one is open is checked
+// on lookup, since input handlers can close it before the next frame
+static struct component_t** modals = NULL;
+static int modal_count = 0;
+static int modal_capacity = 0;
+static bool modals_valid = false;
+
+void hit_test_set_tree(struct component_t* root, int width, int height) {
+    tree = root;
+    tree_width = width > 0 ? width : 0;
+    tree_height = height > 0 ? height : 0;
+    grid_valid = false;
+    modals_valid = false;
+}
+
+/**
+ * Find the first unclaimed cell of a row at or right of x
+ * Returns the row width if there is none
+ */
+static int find_free(int* free_row, int x) {
+    while (free_row[x] != x) {
+        free_row[x] = free_row[free_row[x]];  // Halve the path
+        x = free_row[x];
+    }
+    return x;
+}
+
+/**
+ * Paint a subtree into the grid, top-most first: children in reverse
+ * order before their parent, each claiming only the cells nothing above
+ * it has. Every cell is written once, however deep the tree.
+ */
+static void paint(struct component_t* component) {
+    for (int i = component->child_count - 1; i >= 0; i--) {
+        paint(component->children[i]);
+    }
+
+    int x0 = component->x < 0 ? 0 : component->x;
+    int y0 = component->y < 0 ? 0 : component->y;
+    int x1 = component->x + component->width;
+    int y1 = component->y + component->height;
+    if (x1 > tree_width) x1 = tree_width;
+    if (y1 > tree_height) y1 = tree_height;
+    if (x0 >= x1) {
+        return;
+    }
+
+    for (int y = y0; y < y1; y++) {
+        struct component_t** row = grid + (size_t)y * tree_width;
+        int* free_row = next_free + (size_t)y * (tree_width + 1);
+        for (int x = find_free(free_row, x0); x < x1; x = find_free(free_row, x)) {
+            row[x] = component;
+            free_row[x] = x + 1;
+        }
+    }
+}
+
+static bool build_grid(void) {
+    size_t cells = (size_t)tree_width * tree_height;
+    if (cells > grid_capacity) {
+        struct component_t** new_grid = realloc(grid, cells * sizeof(struct component_t*));
+        if (!new_grid) {
+            return false;
+        }
+        grid = new_grid;
+        grid_capacity = cells;
+    }
+
+    size_t slots = (size_t)(tree_width + 1) * tree_height;
+    if (slots > next_free_capacity) {
+        int* new_next_free = realloc(next_free, slots * sizeof(int));
+        if (!new_next_free) {
+            return false;
+        }
+        next_free = new_next_free;
+        next_free_capacity = slots;
+    }
+
+    for (size_t i = 0; i < cells; i++) {
+        grid[i] = NULL;
+    }
+    for (int y = 0; y < tree_height; y++) {
+        int* free_row = next_free + (size_t)y * (tree_width + 1);
+        for (int x = 0; x <= tree_width; x++) {
+            free_row[x] = x;
+        }
+    }
+    if (tree) {
+        paint(tree);
+    }
+
+    grid_valid = true;
+    return true;
+}
+
+static bool collect_modals(struct component_t* component) {
+    if (component->type == COMPONENT_MODAL) {
+        if (modal_count >= modal_capacity) {
+            int new_capacity = modal_capacity == 0 ? 4 : modal_capacity * 2;
+            struct component_t** new_modals = realloc(modals, new_capacity * sizeof(struct component_t*));
+            if (!new_modals) {
+                return false;
+            }
+            modals = new_modals;
+            modal_capacity = new_capacity;
+        }
+        modals[modal_count++] = component;
+    }
+
+    for (int i = 0; i < component->child_count; i++) {
+        if (!collect_modals(component->children[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Fallback when the grid can't be allocated: walk the tree, top-most first
+ */
+static struct component_t* find_component_at(struct component_t* component, int x, int y) {
+    for (int i = component->child_count - 1; i >= 0; i--) {
+        struct component_t* found = find_component_at(component->children[i], x, y);
+        if (found) {
+            return found;
+        }
+    }
+
+    if (x >= component->x && x < component->x + component->width &&
+        y >= component->y && y < component->y + component->height) {
+        return component;
+    }
+
+    return NULL;
+}
+
+struct component_t* hit_test_at(int x, int y) {
+    if (!tree || x < 0 || y < 0 || x >= tree_width || y >= tree_height) {
+        return NULL;
+    }
+
+    if (!grid_valid && !build_grid()) {
+        return find_component_at(tree, x, y);
+    }
+    return grid[(size_t)y * tree_width + x];
+}
+
+struct component_t* hit_test_open_modal(void) {
+    if (!tree) {
+        return NULL;
+    }
+
+    if (!modals_valid) {
+        modal_count = 0;
+        if (!collect_modals(tree)) {
+            modal_count = 0;
+            return NULL;
+        }
+        modals_valid = true;
+    }
+
+    for (int i = 0; i < modal_count; i++) {
+        modal_data_t* data = (modal_data_t*)modals[i]->data;
+        if (data && data->is_open && *data->is_open) {
+            return modals[i];
+        }
+    }
+    return NULL;
+}
+
+void hit_test_free(void) {
+    free(grid);
+    grid = NULL;
+    grid_capacity = 0;
+    free(next_free);
+    next_free = NULL;
+    next_free_capacity = 0;
+    free(modals);
+    modals = NULL;
+    modal_count = 0;
+    modal_capacity = 0;
+    hit_test_set_tree(NULL, 0, 0);
+}
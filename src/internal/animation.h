@@ -92,6 +92,12 @@ void anim_free(animation_t* anim);
  */
 void anim_start(animation_t* anim);
 
+/**
+ * Stop an animation and mark it complete
+ * A manager holding it frees it on its next cleanup
+ */
+void anim_cancel(animation_t* anim);
+
 /**
  * Update an animation (call every frame)
  * Returns true if animation is still active
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stddef.h>
+
+/**
+ * Arena allocator
+ * Hands out memory by bumping a pointer inside large blocks. Individual
+ * allocations are never freed; the whole arena is released at once with
+ * arena_reset(), which keeps the memory around for reuse.
+ */
+
+typedef struct arena_block_t {
+    struct arena_block_t* next;
+    size_t size;  // Usable bytes in data
+    size_t used;  // Bytes handed out so far
+    char data[];
+} arena_block_t;
+
+typedef struct {
+    arena_block_t* blocks;  // Current block first, older blocks after it
+    size_t block_size;      // Minimum size of newly allocated blocks
+    size_t total_used;      // Bytes handed out since the last reset
+} arena_t;
+
+/**
+ * Initialize an empty arena
+ * No memory is allocated until the first arena_alloc()
+ */
+void arena_init(arena_t* arena, size_t block_size);
+
+/**
+ * Allocate size bytes, aligned for any type
+ * The memory is not zeroed
+ * Returns NULL on allocation failure
+ */
+void* arena_alloc(arena_t* arena, size_t size);
+
+/**
+ * Release everything allocated from the arena
+ * If the last cycle needed several blocks they are merged into one, so a
+ * steady workload resets by rewinding a single pointer
+ */
+void arena_reset(arena_t* arena);
+
+/**
+ * Free all memory owned by the arena
+ */
+void arena_free(arena_t* arena);
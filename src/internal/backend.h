@@ -0,0 +1,82 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/**
+ * Terminal backend
+ * Everything the library takes from the outside world goes through the
+ * active backend: raw mode, output, the screen size, input and the clock.
+ * The tty backend talks to the controlling terminal; the headless backend
+ * (headless.c) emulates one in memory.
+ */
+
+// What backend_t.wait() found ready
+#define BACKEND_INPUT 1  // read() has bytes
+#define BACKEND_WAKE 2   // The wakeup descriptor is readable
+#define BACKEND_END 4    // Nothing will ever arrive on the input again
+
+typedef struct {
+    /**
+     * Put the terminal into raw mode
+     * Returns false if there is no usable terminal
+     */
+    bool (*init)(void);
+
+    /**
+     * Restore the terminal mode init() changed
+     */
+    void (*cleanup)(void);
+
+    /**
+     * Write up to len bytes of output
+     * Returns the number of bytes written, or -1 with errno set
+     */
+    ssize_t (*write)(const char* data, size_t len);
+
+    /**
+     * Get the size in cells
+     */
+    bool (*get_size)(int* width, int* height);
+
+    /**
+     * Sleep up to timeout_ms (-1 = no limit) until input is available or
+     * wake_fd (-1 = none) becomes readable
+     * Returns BACKEND_* flags, 0 on timeout or interruption
+     */
+    int (*wait)(int wake_fd, int timeout_ms);
+
+    /**
+     * Read available input without blocking
+     * Returns the number of bytes read, 0 or -1 if there were none
+     */
+    ssize_t (*read)(unsigned char* buffer, size_t size);
+
+    /**
+     * Current time in microseconds
+     */
+    uint64_t (*now_us)(void);
+
+    /**
+     * Whether REP (repeat preceding character) can be used
+     */
+    bool (*supports_repeat)(void);
+} backend_t;
+
+// The controlling terminal, on stdin/stdout (the default)
+extern const backend_t backend_tty;
+
+// In-memory terminal with scripted input and a virtual clock
+extern const backend_t backend_headless;
+
+/**
+ * Get the active backend
+ */
+const backend_t* backend_get(void);
+
+/**
+ * Switch backends; only before tui_init()
+ */
+void backend_set(const backend_t* backend);
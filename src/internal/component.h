@@ -5,6 +5,7 @@
 #include <stdint.h>
 #include "../include/intuitive.h"
 #include "animation.h"
+#include "arena.h"
 
 /**
  * Component types
@@ -23,6 +24,7 @@ typedef enum {
     COMPONENT_SPACER,
     COMPONENT_SPINNER,
     COMPONENT_TOAST,
+    COMPONENT_MEMO,
 } component_type_t;
 
 /**
@@ -43,6 +45,11 @@ struct component_t {
     int x, y;
     int width, height;
 
+    // Area drawn by the component and everything under it, which can reach
+    // past its own bounds (computed during layout, empty if nothing is drawn)
+    int paint_x, paint_y;
+    int paint_width, paint_height;
+
     // Focus information
     bool focusable;
     bool focused;
@@ -56,13 +63,19 @@ struct component_t {
     // Diffing/reconciliation information
     bool dirty;  // Needs re-render
     unsigned int content_hash;  // Hash of component content for quick comparison
+    const char* key;  // Identity among siblings, set by Keyed() (owned, can be NULL)
+
+    // Memory ownership
+    bool arena_owned;  // Allocated from a frame arena, released with it
 };
 
 /**
  * Text component data
  */
 typedef struct {
-    char* content;
+    const char* content;
+    int length;     // strlen(content), measured once when created
+    bool borrowed;  // content belongs to the caller and is not freed
 } text_data_t;
 
 /**
@@ -87,8 +100,12 @@ typedef struct {
  * List component data
  */
 typedef struct {
-    char** items;
+    const char** items;
     int item_count;
+    bool borrowed;                // items belong to the caller and are not freed
+    const char* (*item_provider)(int index, void* ctx); // Fetches items when items is NULL
+    void* provider_ctx;
+    int item_width;               // Fixed item width (0 = measure)
     int* scroll_offset;           // Pointer to external scroll state
     int max_visible_items;
     int* selected_index;         // Pointer to external selected index (optional)
@@ -97,7 +114,7 @@ typedef struct {
     // Smooth scrolling animation state
     float visual_scroll_offset;   // Current animated scroll position
     int target_scroll_offset;     // Target scroll position
-    animation_t* scroll_animation; // Scroll animation (can be NULL)
+    animation_t* scroll_animation; // Scroll animation, owned by the TUI animation manager (can be NULL)
 } list_data_t;
 
 /**
@@ -126,19 +143,26 @@ typedef struct {
     // Smooth scrolling animation state
     float visual_scroll_offset;   // Current animated scroll position
     int target_scroll_offset;     // Target scroll position
-    animation_t* scroll_animation; // Scroll animation (can be NULL)
+    animation_t* scroll_animation; // Scroll animation, owned by the TUI animation manager (can be NULL)
 } scrollview_data_t;
 
 /**
  * Table component data
  */
 typedef struct {
-    char** headers;         // Array of header strings
+    const char** headers;   // Array of header strings
     int header_count;       // Number of columns
-    char*** rows;           // 2D array of cell strings [row][col]
+    const char*** rows;     // 2D array of cell strings [row][col]
     int row_count;          // Number of rows
     int* column_widths;     // Width of each column (auto-calculated)
     bool show_borders;      // Whether to show borders
+    bool borrowed;          // headers and rows belong to the caller and are not freed
+    const char** (*row_provider)(int row, void* ctx); // Fetches rows when rows is NULL
+    void* provider_ctx;
+    int max_visible_rows;   // Rows shown at once
+    int* scroll_offset;     // Pointer to external scroll state (optional)
+    int* selected_row;      // Pointer to external selected row (optional)
+    void (*on_select)(int row); // Callback when a row is chosen (optional)
 } table_data_t;
 
 /**
@@ -179,6 +203,89 @@ typedef struct {
     void (*on_close)(void);
 } toast_data_t;
 
+/**
+ * Memo component data
+ * The memoized subtree is the component's only child. It belongs to the
+ * memo cache, not to the component.
+ */
+typedef struct {
+    bool reused;                 // Subtree is unchanged from an earlier frame
+    struct memo_entry_t* entry;  // Cache entry holding the subtree
+} memo_data_t;
+
+/**
+ * Get a list item from the item array or the item provider
+ * Never returns NULL; missing items read as empty strings
+ */
+const char* list_get_item(list_data_t* data, int index);
+
+/**
+ * Get the range of list items in view, [*start, *end)
+ * Only these need to be measured, hashed or drawn
+ */
+void list_get_visible_range(list_data_t* data, int* start, int* end);
+
+/**
+ * Get a table row from the row array or the row provider
+ * Returns NULL if the row is out of range or unavailable
+ */
+const char** table_get_row(table_data_t* data, int row);
+
+/**
+ * Get the range of table rows in view, [*start, *end)
+ */
+void table_get_visible_range(table_data_t* data, int* start, int* end);
+
+/**
+ * Get where a toast is drawn on a screen of the given size
+ * The position can be partly off screen
+ */
+void toast_get_rect(toast_data_t* data, int screen_width, int screen_height,
+                    int* x, int* y, int* width, int* height);
+
+/**
+ * Forget every toast's dismiss timer
+ * Called when the timers are dropped at the end of tui_run()
+ */
+void toast_reset(void);
+
+/**
+ * Select where components and their data are allocated
+ * With an arena set, everything built is released together by resetting
+ * the arena and component_free() does nothing for those components.
+ * Pass NULL to allocate from the heap (the default).
+ */
+void component_use_arena(arena_t* arena);
+
+/**
+ * Get the arena set by component_use_arena(), or NULL for the heap
+ */
+arena_t* component_get_arena(void);
+
+/**
+ * Allocate zeroed memory for component data from the current allocator
+ * Returns NULL on allocation failure
+ */
+void* component_alloc(size_t size);
+
+/**
+ * Duplicate a string using the current allocator
+ * Returns NULL on allocation failure
+ */
+char* component_strdup(const char* str);
+
+/**
+ * Release memory from component_alloc()/component_strdup()
+ * Does nothing while an arena is selected
+ */
+void component_dealloc(void* ptr);
+
+/**
+ * Stop the animations referenced by a subtree that is going away
+ * The animation manager frees them on its next cleanup
+ */
+void component_cancel_animations(struct component_t* component);
+
 /**
  * Create a new component of the given type
  * Returns NULL on allocation failure
@@ -193,6 +300,7 @@ bool component_add_child(struct component_t* parent, struct component_t* child);
 
 /**
  * Recursively free a component and all its children
+ * Components allocated from an arena are left to the arena
  */
 void component_free(struct component_t* component);
 
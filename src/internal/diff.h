@@ -10,7 +10,8 @@ unsigned int component_compute_hash(struct component_t* component);
 
 /**
  * Compare and diff two component trees
- * Marks components as dirty if they have changed
+ * Marks components as dirty if they draw differently, and adds where they
+ * were and are now drawn to the next frame's screen damage
  * Returns true if any changes were detected
  */
 bool component_diff_trees(struct component_t* old_tree, struct component_t* new_tree);
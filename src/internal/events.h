@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 
 #define KEY_UP 256
 #define KEY_DOWN 257
@@ -16,6 +17,9 @@ typedef enum {
     EVENT_NONE,
     EVENT_KEY,
     EVENT_MOUSE,
+    EVENT_RESIZE,
+    EVENT_POST,
+    EVENT_PASTE,
     EVENT_QUIT,
 } event_type_t;
 
@@ -30,7 +34,8 @@ typedef enum {
 typedef enum {
     MOUSE_PRESS,
     MOUSE_RELEASE,
-    MOUSE_DRAG,
+    MOUSE_DRAG,  // Moved with a button held
+    MOUSE_MOVE,  // Moved with no button held (only with motion tracking on)
 } mouse_action_t;
 
 typedef struct {
@@ -44,12 +49,47 @@ typedef struct {
             mouse_action_t action;
             int x;  // Column (0-based)
             int y;  // Row (0-based)
+            int scroll_delta;  // Wheel steps, summed over consecutive reports (negative = up)
         } mouse;
+        struct {
+            void (*fn)(void* ctx);  // Posted with event_post(), run it on the UI thread
+            void* ctx;
+        } post;
+        struct {
+            char* text;     // Pasted bytes, NUL-terminated (malloc'd; the receiver frees it)
+            size_t length;
+        } paste;
     } data;
 } event_t;
 
 /**
- * Poll for an event (non-blocking)
- * Returns true if an event was received
+ * Set up the wakeup pipe and the terminal resize handler
+ * Returns true on success; without it event_poll() only wakes for input
+ */
+bool event_init(void);
+
+/**
+ * Stop accepting posts, remove the resize handler and run the callbacks
+ * that are still queued
+ */
+void event_cleanup(void);
+
+/**
+ * Make a sleeping event_poll() return
+ * Safe to call from other threads and from signal handlers
+ */
+void event_wake(void);
+
+/**
+ * Queue fn(ctx) to be returned by event_poll() as an EVENT_POST
+ * Safe to call from other threads. Returns false if posts aren't being
+ * accepted or the queue is full
+ */
+bool event_post(void (*fn)(void* ctx), void* ctx);
+
+/**
+ * Wait for an event
+ * Sleeps up to timeout_ms (-1 = until something happens, 0 = don't wait).
+ * Returns true if an event was received, false on timeout or wakeup
  */
-bool event_poll(event_t* event);
+bool event_poll(event_t* event, int timeout_ms);
@@ -2,11 +2,28 @@
 
 #include "component.h"
 
+/**
+ * Focus registry
+ * Focusable components in tree order, each with an identity taken from its
+ * path in the tree: sibling keys where set, otherwise the component type and
+ * its position among unkeyed siblings of that type. Focus follows identity
+ * from frame to frame, so it stays put when focusables are inserted before
+ * the focused one.
+ */
+
+/**
+ * Focusables of a memoized subtree, so reused subtrees aren't walked
+ * Built by the registry on first use; owned by the memo cache entry
+ */
+typedef struct focus_cache_t focus_cache_t;
+
 /**
  * Build the focus list from a component tree
- * Must be called after building the tree, before rendering
+ * Must be called after building the tree, before diffing and rendering.
+ * The previous list must still point at a live tree.
+ * Returns true if the focused position changed since the last build
  */
-void focus_build_list(struct component_t* root);
+bool focus_build_list(struct component_t* root);
 
 /**
  * Move focus to the next focusable component
@@ -27,7 +44,7 @@ bool focus_prev(void);
 struct component_t* focus_get_current(void);
 
 /**
- * Clear all focus state
+ * Clear all focus state and free the registry
  */
 void focus_clear(void);
 
@@ -36,3 +53,8 @@ void focus_clear(void);
  * Returns true if focus was set successfully
  */
 bool focus_set(struct component_t* component);
+
+/**
+ * Free a subtree's focus cache (NULL is ignored)
+ */
+void focus_cache_free(focus_cache_t* cache);
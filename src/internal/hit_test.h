@@ -0,0 +1,33 @@
+#pragma once
+
+#include "component.h"
+
+/**
+ * Hit testing
+ * Mouse routing and modal lookup against the tree of the last frame.
+ * The index is built lazily, at most once per frame: a grid with the
+ * top-most component of every cell on screen, and the modals in tree order.
+ */
+
+/**
+ * Point hit testing at a newly laid out tree
+ * Only records the tree; the index is rebuilt when it is next queried
+ */
+void hit_test_set_tree(struct component_t* root, int width, int height);
+
+/**
+ * Get the top-most component at a screen position
+ * Later siblings are above earlier ones and children above their parents.
+ * Returns NULL if nothing is there
+ */
+struct component_t* hit_test_at(int x, int y);
+
+/**
+ * Get the first open modal in tree order, or NULL
+ */
+struct component_t* hit_test_open_modal(void);
+
+/**
+ * Free the index
+ */
+void hit_test_free(void);
@@ -16,6 +16,8 @@ void layout_measure(struct component_t* component);
 /**
  * Position phase: Assign positions to all components top-down
  * This sets the x,y coordinates for each component based on
- * its parent's position and layout rules.
+ * its parent's position and layout rules. Reused memo subtrees that
+ * didn't move are skipped unless screen_resized is set: what they place
+ * against the screen, such as Toasts, has to move with it.
  */
-void layout_position(struct component_t* component, int x, int y);
+void layout_position(struct component_t* component, int x, int y, bool screen_resized);
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "component.h"
+#include "focus.h"
+#include <stdint.h>
+
+/**
+ * Memo cache
+ * Subtrees built by Memo() are allocated from the heap and kept here by
+ * key, so they survive the frame arenas and can be handed back unchanged
+ * while their dependency hash stays the same.
+ */
+
+typedef struct memo_entry_t {
+    char* key;
+    uint64_t deps_hash;
+    struct component_t* tree;       // Cached subtree (owned)
+    // ScrollViews in the subtree, outermost first. Their content follows
+    // the scroll animation, so it moves even while the subtree is reused.
+    struct component_t** scrollviews;
+    int scrollview_count;
+    int scrollview_capacity;
+    bool reposition_all;            // The list couldn't be built
+    focus_cache_t* focus_cache;     // Focusables in the subtree (owned, can be NULL)
+
+    unsigned long used_frame;       // Last frame Memo() asked for this entry
+    unsigned long reused_frame;     // Last frame the subtree was handed back as is
+    unsigned long build_count;      // Number of times the builder has run
+
+    // Entry whose builder was running when this one was last used. While
+    // that parent keeps reusing the same build, this entry stays alive.
+    struct memo_entry_t* parent;
+    unsigned long parent_build;
+
+    struct memo_entry_t* next;         // All entries
+    struct memo_entry_t* bucket_next;  // Entries in the same hash bucket
+} memo_entry_t;
+
+/**
+ * Start a new frame
+ */
+void memo_begin_frame(void);
+
+/**
+ * Get the subtree for key, calling builder only if deps_hash changed
+ * Sets *reused when the cached subtree is returned as is, *built when
+ * the builder ran, and *entry to the cache entry, which stays alive for
+ * the frame. Returns NULL if the builder failed, or without calling it if
+ * the key was already used this frame or the entry couldn't be created;
+ * only in that case should the caller build an uncached subtree.
+ */
+struct component_t* memo_get(const char* key, uint64_t deps_hash,
+                             component_t* (*builder)(void* ctx), void* ctx,
+                             bool* reused, bool* built, memo_entry_t** entry);
+
+/**
+ * Call fn on each subtree handed back unchanged this frame
+ * Nested memos inside those subtrees aren't visited separately.
+ */
+void memo_visit_reused(void (*fn)(struct component_t* tree));
+
+/**
+ * Finish a frame, once the previous tree has been diffed
+ * Frees subtrees that were replaced this frame and entries that are no
+ * longer reachable.
+ */
+void memo_end_frame(void);
+
+/**
+ * Free every cached subtree
+ */
+void memo_free_all(void);
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "../include/intuitive.h"
+
+/**
+ * Screen buffer
+ * The renderer draws into an in-memory back buffer of cells. Presenting a
+ * frame compares it against the front buffer (what the terminal currently
+ * shows) and only emits the cells that differ. A frame only redraws the
+ * damaged parts of the back buffer; everything else is left from earlier
+ * frames.
+ */
+
+/**
+ * A single character cell
+ * Unused glyph bytes are always zero so cells can be compared with memcmp
+ */
+typedef struct {
+    char glyph[4];      // UTF-8 bytes of the character (not NUL-terminated)
+    uint8_t glyph_len;  // Number of bytes used in glyph
+    uint8_t fg;         // color_t
+    uint8_t bg;         // color_t
+    uint8_t style;      // style_t flags
+} screen_cell_t;
+
+/**
+ * Allocate front and back buffers for the given size
+ * The first present after init repaints the whole screen
+ * Returns true on success, false on allocation failure
+ */
+bool screen_init(int width, int height);
+
+/**
+ * Free both buffers
+ */
+void screen_free(void);
+
+/**
+ * Resize both buffers, discarding their contents
+ * The whole screen is damaged and the next present repaints it
+ * Returns true on success, false on allocation failure
+ */
+bool screen_resize(int width, int height);
+
+/**
+ * Get the current buffer dimensions
+ */
+void screen_get_size(int* width, int* height);
+
+/**
+ * Forget what the terminal is showing
+ * The next present clears the terminal and repaints every cell
+ */
+void screen_invalidate(void);
+
+/**
+ * Reset the back buffer to blank cells and the default pen
+ */
+void screen_clear(void);
+
+/**
+ * Mark a rectangle as needing a redraw in the next frame
+ * The part outside the buffer is ignored
+ */
+void screen_damage(int x, int y, int width, int height);
+
+/**
+ * Mark the whole screen as needing a redraw in the next frame
+ */
+void screen_damage_all(void);
+
+/**
+ * Start drawing a frame over the damage marked since the last one
+ * Damaged cells are reset to blanks and the pen to its default. Writes
+ * outside the damage are dropped, so the rest of the back buffer keeps
+ * what earlier frames drew. Damage marked from here on is for the next
+ * frame.
+ */
+void screen_begin_frame(void);
+
+/**
+ * Check whether a rectangle overlaps the damage being drawn
+ */
+bool screen_is_damaged(int x, int y, int width, int height);
+
+/**
+ * Move the draw position in the back buffer
+ * Top-left is (0, 0)
+ */
+void screen_move_cursor(int x, int y);
+
+/**
+ * Write a UTF-8 string at the draw position using the current pen
+ * Each code point occupies one cell; cells outside the buffer are dropped
+ */
+void screen_write(const char* str);
+
+/**
+ * Write the first UTF-8 character of glyph count times
+ * Same as count calls to screen_write() with that character
+ */
+void screen_write_repeat(const char* glyph, int count);
+
+/**
+ * Set pen foreground and background colors
+ * Use COLOR_DEFAULT to keep current color
+ */
+void screen_set_color(color_t fg, color_t bg);
+
+/**
+ * Add style flags to the pen
+ */
+void screen_set_style(style_t style);
+
+/**
+ * Reset the pen to default colors and no style
+ */
+void screen_reset_style(void);
+
+/**
+ * Get the cell at (x, y) in the back buffer
+ * Returns NULL if the position is outside the buffer
+ */
+const screen_cell_t* screen_get_cell(int x, int y);
+
+/**
+ * Emit the differences between back and front buffers to the terminal
+ * Only rows in the frame's damage are compared, unless the terminal
+ * contents are unknown. Afterwards the front buffer matches the back buffer.
+ */
+void screen_present(void);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 #include "../include/intuitive.h"
 
 /**
@@ -33,14 +34,97 @@ void term_clear(void);
 /**
  * Move cursor to position (x, y)
  * Top-left is (0, 0)
+ * Uses the cheapest sequence from the tracked cursor position: nothing,
+ * CR/LF/BS, a relative move, or an absolute move
  */
 void term_move_cursor(int x, int y);
 
+/**
+ * Number of bytes term_move_cursor(x, y) would emit right now
+ * Lets callers rewrite cells instead of moving when that is cheaper
+ */
+int term_cursor_move_cost(int x, int y);
+
+/**
+ * Scroll the contents of rows top..bottom (inclusive) by amount lines
+ * Positive amounts move the contents up (SU), negative ones down (SD).
+ * Lines scrolled in are blank in the current background color. Rows
+ * outside the range are left alone by setting the scroll region (DECSTBM)
+ * around the scroll, which leaves the cursor at the top-left corner.
+ */
+void term_scroll_region(int top, int bottom, int amount);
+
+/**
+ * Number of bytes term_scroll_region() would emit for these arguments
+ */
+int term_scroll_region_cost(int top, int bottom, int amount);
+
+/**
+ * Forget the tracked cursor position
+ * Call after emitting anything that moves the cursor behind the tracker's back
+ */
+void term_invalidate_cursor(void);
+
 /**
  * Write string at current cursor position
+ * Output is buffered until term_flush()
  */
 void term_write(const char* str);
 
+/**
+ * Write len bytes at current cursor position
+ * Output is buffered until term_flush()
+ */
+void term_write_len(const char* str, size_t len);
+
+/**
+ * Write a single character count times
+ * Uses REP when the terminal is known to support it and that is shorter
+ */
+void term_write_repeated(const char* glyph, size_t len, int count);
+
+/**
+ * Erase count characters from the cursor onwards (ECH)
+ * Erased cells take the current background color; the cursor stays put
+ */
+void term_erase_chars(int count);
+
+/**
+ * Number of bytes term_erase_chars(count) emits
+ */
+int term_erase_chars_cost(int count);
+
+/**
+ * Erase from the cursor to the end of the line (EL)
+ * Erased cells take the current background color; the cursor stays put
+ */
+void term_erase_line(void);
+
+/**
+ * Send all buffered output to the terminal
+ * Called once at the end of every frame; call it earlier when output
+ * must reach the terminal immediately
+ */
+void term_flush(void);
+
+/**
+ * Output statistics since the last term_reset_output_stats()
+ */
+typedef struct {
+    unsigned long syscalls;  // write() calls issued
+    unsigned long bytes;     // Bytes written to the terminal
+} term_output_stats_t;
+
+/**
+ * Get output statistics accumulated since the last reset
+ */
+void term_get_output_stats(term_output_stats_t* stats);
+
+/**
+ * Reset output statistics to zero
+ */
+void term_reset_output_stats(void);
+
 /**
  * Get terminal dimensions
  * Stores width and height in provided pointers
@@ -61,25 +145,58 @@ void term_show_cursor(void);
 /**
  * Set foreground and background colors
  * Use COLOR_DEFAULT to keep current color
+ * Nothing is emitted if the terminal already uses these colors
  */
 void term_set_color(color_t fg, color_t bg);
 
 /**
  * Set text style (bold, underline, etc.)
+ * Style flags are added to the current pen
  */
 void term_set_style(style_t style);
 
+/**
+ * Set the complete pen (colors and style) in one call
+ * Only the attributes that differ from the terminal's current pen are emitted
+ */
+void term_set_pen(color_t fg, color_t bg, style_t style);
+
 /**
  * Reset all colors and styles to default
+ * Nothing is emitted if the pen is already default
  */
 void term_reset_style(void);
 
+/**
+ * Begin a synchronized update (DEC private mode 2026)
+ * The terminal holds back presenting output until term_end_sync_update()
+ * Does nothing unless the terminal reported support for the mode
+ */
+void term_begin_sync_update(void);
+
+/**
+ * End a synchronized update and let the terminal present the frame
+ */
+void term_end_sync_update(void);
+
+/**
+ * Record whether the terminal supports synchronized updates
+ * Called by the event parser when the DECRQM reply sent by term_init() arrives
+ */
+void term_set_sync_update_supported(bool supported);
+
 /**
  * Enable mouse tracking
  * Terminal will report mouse events
  */
 void term_enable_mouse(void);
 
+/**
+ * Choose whether mouse movement without a button held is reported
+ * Off by default; takes effect immediately once the terminal is set up
+ */
+void term_set_mouse_motion(bool enabled);
+
 /**
  * Disable mouse tracking
  */
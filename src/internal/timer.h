@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Timer wheel
+ * Timers hash into a ring of slots by their expiry tick (1 ms), so adding,
+ * cancelling and firing a timer are O(1). Timers further out than one turn
+ * of the wheel wait in their slot until their tick comes around.
+ * Only used from the UI thread.
+ */
+
+#define TIMER_WHEEL_SLOTS 1024   // Power of two; one turn is ~1 second
+#define TIMER_TICK_US 1000
+
+/**
+ * Start a timer firing fn(ctx) after delay_ms, then every interval_ms
+ * (0 = fire once). Times are from anim_get_time_us()
+ * Returns a timer id (> 0), or 0 on allocation failure
+ */
+int timer_add(uint64_t now_us, int delay_ms, int interval_ms,
+              void (*fn)(void* ctx), void* ctx);
+
+/**
+ * Cancel a timer
+ * Returns false if the id doesn't name a pending timer
+ */
+bool timer_cancel(int id);
+
+/**
+ * Fire every timer that is due at now_us
+ * Returns true if any timer fired
+ */
+bool timer_run_due(uint64_t now_us);
+
+/**
+ * Get the time the next timer is due
+ * Returns false if no timers are pending
+ */
+bool timer_next_deadline(uint64_t* deadline_us);
+
+/**
+ * Drop all timers and free the wheel
+ */
+void timer_free_all(void);
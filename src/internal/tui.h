@@ -1,5 +1,11 @@
 #pragma once
 
+#include "animation.h"
+#include <stdint.h>
+
+// Frame interval for running animations (~60 fps)
+#define TUI_ANIMATION_FRAME_US 16667
+
 /**
  * Internal TUI functions
  */
@@ -9,3 +15,16 @@
  * Called by renderer when an input is focused
  */
 void tui_set_cursor(int x, int y);
+
+/**
+ * Hand an animation to the TUI animation manager
+ * The manager frees it once it has completed or been cancelled
+ */
+void tui_add_animation(animation_t* anim);
+
+/**
+ * Render a frame no later than time_us (as from anim_get_time_us())
+ * Animations call this while drawing to schedule their next frame; the
+ * event loop otherwise sleeps until input arrives.
+ */
+void tui_schedule_frame(uint64_t time_us);
@@ -1,7 +1,12 @@
 #include "internal/layout.h"
 #include "internal/component.h"
+#include "internal/memo.h"
+#include "internal/screen.h"
 #include <string.h>
 
+// Set while layout_position() runs for a frame after a resize
+static bool reposition_memos = false;
+
 /**
  * Measure a single component's size
  */
@@ -13,7 +18,7 @@ static void measure_component(struct component_t* component) {
     switch (component->type) {
         case COMPONENT_TEXT: {
             text_data_t* data = (text_data_t*)component->data;
-            component->width = data->content ? strlen(data->content) : 0;
+            component->width = data->length;
             component->height = 1;
             break;
         }
@@ -27,10 +32,15 @@ static void measure_component(struct component_t* component) {
 
         case COMPONENT_INPUT: {
             input_data_t* data = (input_data_t*)component->data;
-            size_t content_len = strlen(data->buffer);
             size_t min_width = 20;
             size_t max_width = 60;
 
+            // Past max_width the length no longer matters
+            size_t content_len = 0;
+            while (content_len <= max_width && data->buffer[content_len]) {
+                content_len++;
+            }
+
             if (content_len < min_width) {
                 component->width = min_width + 2;
             } else if (content_len > max_width) {
@@ -44,12 +54,20 @@ static void measure_component(struct component_t* component) {
 
         case COMPONENT_LIST: {
             list_data_t* data = (list_data_t*)component->data;
-            int max_width = 0;
-
-            for (int i = 0; i < data->item_count; i++) {
-                int item_len = strlen(data->items[i]);
-                if (item_len > max_width) {
-                    max_width = item_len;
+            int max_width = data->item_width;
+
+            if (max_width == 0) {
+                // A data source only measures what's in view
+                int start = 0;
+                int end = data->item_count;
+                if (!data->items) {
+                    list_get_visible_range(data, &start, &end);
+                }
+                for (int i = start; i < end; i++) {
+                    int item_len = strlen(list_get_item(data, i));
+                    if (item_len > max_width) {
+                        max_width = item_len;
+                    }
                 }
             }
 
@@ -109,11 +127,13 @@ static void measure_component(struct component_t* component) {
 
             component->width = total_width;
 
-            // Height: header + separator + rows + borders
+            // Height: header + separator + visible rows + borders
+            int visible_rows = data->row_count < data->max_visible_rows ?
+                               data->row_count : data->max_visible_rows;
             if (data->show_borders) {
-                component->height = 3 + data->row_count; // top border + header + sep + rows
+                component->height = 3 + visible_rows; // top border + header + sep + rows
             } else {
-                component->height = 2 + data->row_count; // header + sep + rows
+                component->height = 2 + visible_rows; // header + sep + rows
             }
             break;
         }
@@ -204,6 +224,15 @@ static void measure_component(struct component_t* component) {
             break;
         }
 
+        case COMPONENT_MEMO: {
+            // Same size as the memoized subtree
+            if (component->child_count > 0) {
+                component->width = component->children[0]->width;
+                component->height = component->children[0]->height;
+            }
+            break;
+        }
+
         case COMPONENT_TOAST: {
             // Toast positions itself absolutely during rendering
             // It doesn't participate in parent layout flow
@@ -219,6 +248,12 @@ void layout_measure(struct component_t* component) {
         return;
     }
 
+    // A reused memo subtree keeps the sizes measured when it was built
+    if (component->type == COMPONENT_MEMO && ((memo_data_t*)component->data)->reused) {
+        measure_component(component);
+        return;
+    }
+
     // Measure children first (bottom-up)
     for (int i = 0; i < component->child_count; i++) {
         layout_measure(component->children[i]);
@@ -246,7 +281,118 @@ void layout_measure(struct component_t* component) {
     measure_component(component);
 }
 
-void layout_position(struct component_t* component, int x, int y) {
+/**
+ * Row of a ScrollView's content: offset by the visual (animated) scroll amount
+ */
+static int scrollview_content_y(struct component_t* component) {
+    scrollview_data_t* data = (scrollview_data_t*)component->data;
+    return component->y - (int)(data->visual_scroll_offset + 0.5f);
+}
+
+/**
+ * Grow a component's paint area to cover a rectangle
+ */
+static void extend_paint_area(struct component_t* component, int x, int y, int width, int height) {
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+    if (component->paint_width <= 0 || component->paint_height <= 0) {
+        component->paint_x = x;
+        component->paint_y = y;
+        component->paint_width = width;
+        component->paint_height = height;
+        return;
+    }
+
+    int right = component->paint_x + component->paint_width;
+    int bottom = component->paint_y + component->paint_height;
+    if (x + width > right) right = x + width;
+    if (y + height > bottom) bottom = y + height;
+    if (x < component->paint_x) component->paint_x = x;
+    if (y < component->paint_y) component->paint_y = y;
+    component->paint_width = right - component->paint_x;
+    component->paint_height = bottom - component->paint_y;
+}
+
+static void extend_paint_area_to(struct component_t* component, struct component_t* child) {
+    if (child) {
+        extend_paint_area(component, child->paint_x, child->paint_y,
+                          child->paint_width, child->paint_height);
+    }
+}
+
+/**
+ * Compute the area a positioned component and its children draw into
+ */
+static void update_paint_area(struct component_t* component) {
+    component->paint_x = component->x;
+    component->paint_y = component->y;
+    component->paint_width = component->width;
+    component->paint_height = component->height;
+
+    switch (component->type) {
+        case COMPONENT_LIST:
+            // Items are drawn after a two-column selection marker
+            component->paint_width += 2;
+            break;
+
+        case COMPONENT_SCROLLVIEW: {
+            // The scroll bar sits one column past the viewport. Content
+            // is clipped to the viewport.
+            scrollview_data_t* data = (scrollview_data_t*)component->data;
+            if (data && data->show_indicators) {
+                component->paint_width += 2;
+            }
+            break;
+        }
+
+        case COMPONENT_MODAL: {
+            modal_data_t* data = (modal_data_t*)component->data;
+            if (!data || !data->is_open || !*data->is_open) {
+                component->paint_width = 0;
+                component->paint_height = 0;
+            } else {
+                extend_paint_area_to(component, data->content);
+            }
+            break;
+        }
+
+        case COMPONENT_TOAST: {
+            toast_data_t* data = (toast_data_t*)component->data;
+            component->paint_width = 0;
+            component->paint_height = 0;
+            if (data && data->message && data->is_visible && *data->is_visible) {
+                int screen_width, screen_height;
+                int toast_x, toast_y, toast_width, toast_height;
+                screen_get_size(&screen_width, &screen_height);
+                toast_get_rect(data, screen_width, screen_height,
+                               &toast_x, &toast_y, &toast_width, &toast_height);
+                extend_paint_area(component, toast_x, toast_y, toast_width, toast_height);
+            }
+            break;
+        }
+
+        case COMPONENT_PADDING: {
+            padding_data_t* data = (padding_data_t*)component->data;
+            if (data) {
+                extend_paint_area_to(component, data->child);
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    for (int i = 0; i < component->child_count; i++) {
+        extend_paint_area_to(component, component->children[i]);
+    }
+}
+
+/**
+ * Position a subtree; see layout_position()
+ */
+static void position_component(struct component_t* component, int x, int y) {
     if (!component) {
         return;
     }
@@ -267,6 +413,31 @@ void layout_position(struct component_t* component, int x, int y) {
             // These components don't have children or position themselves
             break;
 
+        case COMPONENT_MEMO: {
+            memo_data_t* data = (memo_data_t*)component->data;
+            if (component->child_count > 0) {
+                struct component_t* child = component->children[0];
+                memo_entry_t* entry = data->entry;
+                if (!data->reused || !entry || entry->reposition_all || reposition_memos ||
+                    child->x != x || child->y != y) {
+                    position_component(child, x, y);
+                } else {
+                    // A reused subtree that didn't move is already in place,
+                    // except for ScrollView content following its animation
+                    for (int i = 0; i < entry->scrollview_count; i++) {
+                        struct component_t* scrollview = entry->scrollviews[i];
+                        scrollview_data_t* scroll_data = (scrollview_data_t*)scrollview->data;
+                        int content_y = scrollview_content_y(scrollview);
+                        if (scroll_data->content && (scroll_data->content->x != scrollview->x ||
+                                                     scroll_data->content->y != content_y)) {
+                            position_component(scroll_data->content, scrollview->x, content_y);
+                        }
+                    }
+                }
+            }
+            break;
+        }
+
         case COMPONENT_MODAL: {
             modal_data_t* data = (modal_data_t*)component->data;
             if (data && data->content) {
@@ -282,7 +453,7 @@ void layout_position(struct component_t* component, int x, int y) {
                 if (data->title) {
                     content_y++;
                 }
-                layout_position(data->content, content_x, content_y);
+                position_component(data->content, content_x, content_y);
             }
             break;
         }
@@ -290,9 +461,7 @@ void layout_position(struct component_t* component, int x, int y) {
         case COMPONENT_SCROLLVIEW: {
             scrollview_data_t* data = (scrollview_data_t*)component->data;
             if (data && data->content) {
-                // Position content, offset by visual (animated) scroll amount
-                int visual_offset = (int)(data->visual_scroll_offset + 0.5f);
-                layout_position(data->content, x, y - visual_offset);
+                position_component(data->content, x, scrollview_content_y(component));
             }
             break;
         }
@@ -303,7 +472,7 @@ void layout_position(struct component_t* component, int x, int y) {
                 // Position child inside padding
                 int child_x = x + data->padding.left;
                 int child_y = y + data->padding.top;
-                layout_position(data->child, child_x, child_y);
+                position_component(data->child, child_x, child_y);
             }
             break;
         }
@@ -326,7 +495,7 @@ void layout_position(struct component_t* component, int x, int y) {
                     child_x = x + (component->width - child->width);
                 }
 
-                layout_position(child, child_x, current_y);
+                position_component(child, child_x, current_y);
                 current_y += child->height + spacing;
             }
             break;
@@ -350,10 +519,18 @@ void layout_position(struct component_t* component, int x, int y) {
                     child_y = y + (component->height - child->height);
                 }
 
-                layout_position(child, current_x, child_y);
+                position_component(child, current_x, child_y);
                 current_x += child->width + spacing;
             }
             break;
         }
     }
+
+    update_paint_area(component);
+}
+
+void layout_position(struct component_t* component, int x, int y, bool screen_resized) {
+    reposition_memos = screen_resized;
+    position_component(component, x, y);
+    reposition_memos = false;
 }
@@ -0,0 +1,266 @@
+#include "internal/memo.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define MEMO_BUCKETS 256
+
+static memo_entry_t* buckets[MEMO_BUCKETS];
+static memo_entry_t* entries = NULL;
+static unsigned long frame = 0;
+
+// Entry whose builder is running, for tracking nested memos
+static memo_entry_t* building = NULL;
+
+// Subtrees replaced this frame; the previous tree may still point at them
+static struct component_t** retired = NULL;
+static int retired_count = 0;
+static int retired_capacity = 0;
+
+static unsigned int hash_key(const char* key) {
+    unsigned int hash = 5381;
+    int c;
+
+    while ((c = (unsigned char)*key++)) {
+        hash = ((hash << 5) + hash) + c;
+    }
+
+    return hash;
+}
+
+static memo_entry_t* find_entry(const char* key) {
+    memo_entry_t* entry = buckets[hash_key(key) % MEMO_BUCKETS];
+    while (entry && strcmp(entry->key, key) != 0) {
+        entry = entry->bucket_next;
+    }
+    return entry;
+}
+
+static memo_entry_t* create_entry(const char* key) {
+    memo_entry_t* entry = calloc(1, sizeof(memo_entry_t));
+    if (!entry) {
+        return NULL;
+    }
+
+    size_t len = strlen(key) + 1;
+    entry->key = malloc(len);
+    if (!entry->key) {
+        free(entry);
+        return NULL;
+    }
+    memcpy(entry->key, key, len);
+
+    unsigned int bucket = hash_key(key) % MEMO_BUCKETS;
+    entry->bucket_next = buckets[bucket];
+    buckets[bucket] = entry;
+    entry->next = entries;
+    entries = entry;
+    return entry;
+}
+
+static void retire(struct component_t* tree) {
+    if (!tree) {
+        return;
+    }
+
+    if (retired_count >= retired_capacity) {
+        int new_capacity = retired_capacity == 0 ? 8 : retired_capacity * 2;
+        struct component_t** new_retired = realloc(retired, new_capacity * sizeof(struct component_t*));
+        if (!new_retired) {
+            // Can't defer it, and freeing now could leave the previous tree
+            // dangling; leaking is the lesser evil
+            return;
+        }
+        retired = new_retired;
+        retired_capacity = new_capacity;
+    }
+    retired[retired_count++] = tree;
+}
+
+/**
+ * Record the ScrollViews of a subtree in the entry, outermost first
+ * Returns false on allocation failure
+ */
+static bool collect_scrollviews(memo_entry_t* entry, struct component_t* component) {
+    if (!component) {
+        return true;
+    }
+
+    switch (component->type) {
+        case COMPONENT_SCROLLVIEW:
+            if (entry->scrollview_count >= entry->scrollview_capacity) {
+                int new_capacity = entry->scrollview_capacity == 0 ? 4 : entry->scrollview_capacity * 2;
+                struct component_t** new_scrollviews = realloc(entry->scrollviews,
+                                                               new_capacity * sizeof(struct component_t*));
+                if (!new_scrollviews) {
+                    return false;
+                }
+                entry->scrollviews = new_scrollviews;
+                entry->scrollview_capacity = new_capacity;
+            }
+            entry->scrollviews[entry->scrollview_count++] = component;
+            return collect_scrollviews(entry, ((scrollview_data_t*)component->data)->content);
+        case COMPONENT_MODAL:
+            if (!collect_scrollviews(entry, ((modal_data_t*)component->data)->content)) {
+                return false;
+            }
+            break;
+        case COMPONENT_PADDING:
+            if (!collect_scrollviews(entry, ((padding_data_t*)component->data)->child)) {
+                return false;
+            }
+            break;
+        default:
+            // Nested memos are included: they can't be rebuilt while this
+            // subtree is reused
+            break;
+    }
+
+    for (int i = 0; i < component->child_count; i++) {
+        if (!collect_scrollviews(entry, component->children[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void memo_begin_frame(void) {
+    frame++;
+}
+
+struct component_t* memo_get(const char* key, uint64_t deps_hash,
+                             component_t* (*builder)(void* ctx), void* ctx,
+                             bool* reused, bool* built, memo_entry_t** entry_out) {
+    *reused = false;
+    *built = false;
+    *entry_out = NULL;
+
+    memo_entry_t* entry = find_entry(key);
+    if (!entry) {
+        entry = create_entry(key);
+        if (!entry) {
+            return NULL;
+        }
+    } else if (entry->used_frame == frame) {
+        // Same key twice in one frame; a subtree can only be in one place
+        return NULL;
+    }
+
+    entry->used_frame = frame;
+    entry->parent = building;
+    entry->parent_build = building ? building->build_count : 0;
+
+    if (entry->tree && entry->deps_hash == deps_hash) {
+        entry->reused_frame = frame;
+        *reused = true;
+        *entry_out = entry;
+        return entry->tree;
+    }
+
+    // Build on the heap so the subtree outlives the frame arena
+    arena_t* arena = component_get_arena();
+    memo_entry_t* outer = building;
+    component_use_arena(NULL);
+    entry->build_count++;
+    building = entry;
+
+    struct component_t* tree = builder(ctx);
+    *built = true;
+
+    building = outer;
+    component_use_arena(arena);
+
+    if (!tree) {
+        return NULL;
+    }
+
+    retire(entry->tree);
+    entry->tree = tree;
+    entry->deps_hash = deps_hash;
+    entry->scrollview_count = 0;
+    entry->reposition_all = !collect_scrollviews(entry, tree);
+    focus_cache_free(entry->focus_cache);
+    entry->focus_cache = NULL;
+    *entry_out = entry;
+    return tree;
+}
+
+void memo_visit_reused(void (*fn)(struct component_t* tree)) {
+    for (memo_entry_t* entry = entries; entry; entry = entry->next) {
+        if (entry->reused_frame == frame && entry->tree) {
+            fn(entry->tree);
+        }
+    }
+}
+
+/**
+ * Check whether an entry is still part of the UI
+ * Either Memo() asked for it this frame, or it belongs to a build of its
+ * parent that is still being reused.
+ */
+static bool entry_alive(memo_entry_t* entry) {
+    if (entry->used_frame == frame) {
+        return true;
+    }
+    return entry->parent && entry->parent->build_count == entry->parent_build &&
+           entry_alive(entry->parent);
+}
+
+static void free_entry(memo_entry_t* entry) {
+    component_free(entry->tree);
+    focus_cache_free(entry->focus_cache);
+    free(entry->scrollviews);
+    free(entry->key);
+    free(entry);
+}
+
+void memo_end_frame(void) {
+    for (int i = 0; i < retired_count; i++) {
+        component_free(retired[i]);
+    }
+    retired_count = 0;
+
+    // Decide first, then free: liveness looks at parents
+    memo_entry_t* dead = NULL;
+    memo_entry_t** link = &entries;
+    while (*link) {
+        memo_entry_t* entry = *link;
+        if (entry_alive(entry)) {
+            link = &entry->next;
+            continue;
+        }
+
+        // Unlink from its bucket and the entry list
+        memo_entry_t** bucket_link = &buckets[hash_key(entry->key) % MEMO_BUCKETS];
+        while (*bucket_link != entry) {
+            bucket_link = &(*bucket_link)->bucket_next;
+        }
+        *bucket_link = entry->bucket_next;
+        *link = entry->next;
+
+        entry->next = dead;
+        dead = entry;
+    }
+
+    while (dead) {
+        memo_entry_t* next = dead->next;
+        free_entry(dead);
+        dead = next;
+    }
+}
+
+void memo_free_all(void) {
+    for (int i = 0; i < retired_count; i++) {
+        component_free(retired[i]);
+    }
+    free(retired);
+    retired = NULL;
+    retired_count = 0;
+    retired_capacity = 0;
+
+    while (entries) {
+        memo_entry_t* next = entries->next;
+        free_entry(entries);
+        entries = next;
+    }
+    memset(buckets, 0, sizeof(buckets));
+}
@@ -1,6 +1,6 @@
 #include "internal/renderer.h"
 #include "internal/component.h"
-#include "internal/terminal.h"
+#include "internal/screen.h"
 #include "internal/tui.h"
 #include "internal/animation.h"
 #include <string.h>
@@ -38,35 +38,94 @@ static void write_padded(const char* str, int width) {
         // String too long, truncate
         for (int i = 0; i < width; i++) {
             char buf[2] = {str[i], '\0'};
-            term_write(buf);
+            screen_write(buf);
         }
     } else {
         // Write string and pad with spaces
-        term_write(str);
-        for (int i = len; i < width; i++) {
-            term_write(" ");
-        }
+        screen_write(str);
+        screen_write_repeat(" ", width - len);
     }
 }
 
-void render_component(struct component_t* component) {
-    if (!component) {
-        return;
-    }
-
-    // Apply component styling
+/**
+ * Apply a component's own colors and style to the pen
+ * Returns false if the component has no styling
+ */
+static bool apply_component_style(struct component_t* component) {
     bool has_style = (component->fg_color != COLOR_DEFAULT ||
                       component->bg_color != COLOR_DEFAULT ||
                       component->style != STYLE_NONE);
 
     if (has_style) {
         if (component->fg_color != COLOR_DEFAULT || component->bg_color != COLOR_DEFAULT) {
-            term_set_color(component->fg_color, component->bg_color);
+            screen_set_color(component->fg_color, component->bg_color);
         }
         if (component->style != STYLE_NONE) {
-            term_set_style(component->style);
+            screen_set_style(component->style);
         }
     }
+    return has_style;
+}
+
+/**
+ * Write one table row, highlighting it if it is the selected row
+ * Missing cells are drawn empty.
+ */
+static void write_table_row(struct component_t* component, table_data_t* data, int row) {
+    const char** cells = table_get_row(data, row);
+    bool selected = data->selected_row && *data->selected_row == row;
+
+    if (selected) {
+        screen_set_style(component->focused ? STYLE_BOLD | STYLE_UNDERLINE : STYLE_BOLD);
+    }
+
+    if (data->show_borders) {
+        screen_write("|");
+    }
+    for (int col = 0; col < data->header_count; col++) {
+        const char* cell = cells && cells[col] ? cells[col] : "";
+        if (data->show_borders) {
+            screen_write(" ");
+            write_padded(cell, data->column_widths[col]);
+            screen_write(" |");
+        } else {
+            write_padded(cell, data->column_widths[col]);
+            if (col < data->header_count - 1) {
+                screen_write("  ");
+            }
+        }
+    }
+
+    if (selected) {
+        screen_reset_style();
+        apply_component_style(component);
+    }
+}
+
+/**
+ * Draw a component again in the frame rendered by time_us
+ * Animations change what is drawn without changing the tree, so the diff
+ * doesn't see them.
+ */
+static void redraw_at(struct component_t* component, uint64_t time_us) {
+    screen_damage(component->paint_x, component->paint_y,
+                  component->paint_width, component->paint_height);
+    tui_schedule_frame(time_us);
+}
+
+void render_component(struct component_t* component) {
+    if (!component) {
+        return;
+    }
+
+    // Outside the damage the back buffer still holds what it drew last
+    if (!screen_is_damaged(component->paint_x, component->paint_y,
+                           component->paint_width, component->paint_height)) {
+        return;
+    }
+
+    // Apply component styling
+    bool has_style = apply_component_style(component);
 
     switch (component->type) {
         case COMPONENT_TEXT: {
@@ -76,8 +135,8 @@ void render_component(struct component_t* component) {
                 if (render_is_clipped(component->x, component->y)) {
                     break;
                 }
-                term_move_cursor(component->x, component->y);
-                term_write(data->content);
+                screen_move_cursor(component->x, component->y);
+                screen_write(data->content);
             }
             break;
         }
@@ -89,15 +148,15 @@ void render_component(struct component_t* component) {
                 if (render_is_clipped(component->x, component->y)) {
                     break;
                 }
-                term_move_cursor(component->x, component->y);
+                screen_move_cursor(component->x, component->y);
                 if (component->focused) {
-                    term_write(">");
-                    term_write(data->label);
-                    term_write("<");
+                    screen_write(">");
+                    screen_write(data->label);
+                    screen_write("<");
                 } else {
-                    term_write("[");
-                    term_write(data->label);
-                    term_write("]");
+                    screen_write("[");
+                    screen_write(data->label);
+                    screen_write("]");
                 }
             }
             break;
@@ -122,8 +181,8 @@ void render_component(struct component_t* component) {
                 }
                 data->scroll_offset = scroll;
 
-                term_move_cursor(component->x, component->y);
-                term_write("[");
+                screen_move_cursor(component->x, component->y);
+                screen_write("[");
 
                 size_t visible_start = scroll;
                 size_t visible_end = scroll + display_width;
@@ -133,14 +192,12 @@ void render_component(struct component_t* component) {
 
                 for (size_t i = visible_start; i < visible_end; i++) {
                     char buf[2] = {data->buffer[i], '\0'};
-                    term_write(buf);
+                    screen_write(buf);
                 }
 
-                for (size_t i = visible_end - visible_start; i < (size_t)display_width; i++) {
-                    term_write(" ");
-                }
+                screen_write_repeat(" ", display_width - (int)(visible_end - visible_start));
 
-                term_write("]");
+                screen_write("]");
 
                 if (component->focused) {
                     tui_set_cursor(component->x + 1 + (data->cursor_pos - scroll), component->y);
@@ -151,16 +208,14 @@ void render_component(struct component_t* component) {
 
         case COMPONENT_LIST: {
             list_data_t* data = (list_data_t*)component->data;
-            if (data && data->items) {
+            if (data && (data->items || data->item_provider)) {
                 // Get external target scroll offset
                 int external_offset = data->scroll_offset ? *data->scroll_offset : 0;
 
                 // Check if target changed - if so, start smooth scroll animation
                 if (external_offset != data->target_scroll_offset) {
-                    // Clean up old animation if exists
-                    if (data->scroll_animation) {
-                        anim_free(data->scroll_animation);
-                    }
+                    // Stop the old animation if exists (the manager frees it)
+                    anim_cancel(data->scroll_animation);
 
                     // Create smooth scroll animation (150ms, ease-out)
                     data->scroll_animation = anim_create(
@@ -170,6 +225,7 @@ void render_component(struct component_t* component) {
                         EASE_OUT
                     );
                     anim_start(data->scroll_animation);
+                    tui_add_animation(data->scroll_animation);
                     data->target_scroll_offset = external_offset;
                 }
 
@@ -177,11 +233,10 @@ void render_component(struct component_t* component) {
                 if (data->scroll_animation) {
                     if (anim_update(data->scroll_animation)) {
                         data->visual_scroll_offset = anim_get_value(data->scroll_animation);
-                        tui_request_render();  // Continue animating
+                        redraw_at(component, anim_get_time_us() + TUI_ANIMATION_FRAME_US);  // Continue animating
                     } else {
                         // Animation complete
                         data->visual_scroll_offset = (float)data->target_scroll_offset;
-                        anim_free(data->scroll_animation);
                         data->scroll_animation = NULL;
                     }
                 }
@@ -203,18 +258,19 @@ void render_component(struct component_t* component) {
                     if (render_is_clipped(component->x, y)) {
                         continue;
                     }
-                    term_move_cursor(component->x, y);
+                    screen_move_cursor(component->x, y);
+                    const char* item = list_get_item(data, i);
 
                     // Show selection indicator if this item is selected
                     if (i == selected && component->focused) {
-                        term_write("> ");
-                        term_write(data->items[i]);
+                        screen_write("> ");
+                        screen_write(item);
                     } else if (i == selected) {
-                        term_write("* ");
-                        term_write(data->items[i]);
+                        screen_write("* ");
+                        screen_write(item);
                     } else {
-                        term_write("  ");
-                        term_write(data->items[i]);
+                        screen_write("  ");
+                        screen_write(item);
                     }
                 }
             }
@@ -229,10 +285,8 @@ void render_component(struct component_t* component) {
 
                 // Check if target changed - if so, start smooth scroll animation
                 if (external_offset != data->target_scroll_offset) {
-                    // Clean up old animation if exists
-                    if (data->scroll_animation) {
-                        anim_free(data->scroll_animation);
-                    }
+                    // Stop the old animation if exists (the manager frees it)
+                    anim_cancel(data->scroll_animation);
 
                     // Create smooth scroll animation (150ms, ease-out)
                     data->scroll_animation = anim_create(
@@ -242,6 +296,7 @@ void render_component(struct component_t* component) {
                         EASE_OUT
                     );
                     anim_start(data->scroll_animation);
+                    tui_add_animation(data->scroll_animation);
                     data->target_scroll_offset = external_offset;
                 }
 
@@ -249,11 +304,10 @@ void render_component(struct component_t* component) {
                 if (data->scroll_animation) {
                     if (anim_update(data->scroll_animation)) {
                         data->visual_scroll_offset = anim_get_value(data->scroll_animation);
-                        tui_request_render();  // Continue animating
+                        redraw_at(component, anim_get_time_us() + TUI_ANIMATION_FRAME_US);  // Continue animating
                     } else {
                         // Animation complete
                         data->visual_scroll_offset = (float)data->target_scroll_offset;
-                        anim_free(data->scroll_animation);
                         data->scroll_animation = NULL;
                     }
                 }
@@ -263,10 +317,8 @@ void render_component(struct component_t* component) {
 
                 // Clear the viewport area first
                 for (int row = 0; row < component->height; row++) {
-                    term_move_cursor(component->x, component->y + row);
-                    for (int col = 0; col < component->width; col++) {
-                        term_write(" ");
-                    }
+                    screen_move_cursor(component->x, component->y + row);
+                    screen_write_repeat(" ", component->width);
                 }
 
                 // Set clipping rectangle to viewport bounds
@@ -302,30 +354,30 @@ void render_component(struct component_t* component) {
 
                         // Draw the scroll bar
                         for (int row = 0; row < viewport_height; row++) {
-                            term_move_cursor(scrollbar_x, component->y + row);
+                            screen_move_cursor(scrollbar_x, component->y + row);
 
                             if (row >= thumb_pos && row < thumb_pos + thumb_size) {
                                 // Draw thumb (use configured characters)
                                 if (component->focused) {
-                                    term_write(data->thumb_focused);
+                                    screen_write(data->thumb_focused);
                                 } else {
-                                    term_write(data->thumb_unfocused);
+                                    screen_write(data->thumb_unfocused);
                                 }
                             } else {
                                 // Draw track (use configured character)
-                                term_write(data->track_char);
+                                screen_write(data->track_char);
                             }
                         }
 
                         // Draw arrows at top and bottom if configured and there's content in that direction
                         if (data->show_arrows) {
                             if (scroll_offset > 0) {
-                                term_move_cursor(scrollbar_x, component->y);
-                                term_write("▲");
+                                screen_move_cursor(scrollbar_x, component->y);
+                                screen_write("▲");
                             }
                             if (scroll_offset + viewport_height < content_height) {
-                                term_move_cursor(scrollbar_x, component->y + viewport_height - 1);
-                                term_write("▼");
+                                screen_move_cursor(scrollbar_x, component->y + viewport_height - 1);
+                                screen_write("▼");
                             }
                         }
                     }
@@ -353,30 +405,26 @@ void render_component(struct component_t* component) {
 
             // Clear entire modal background first
             for (int row = 0; row < h; row++) {
-                term_move_cursor(x, y + row);
-                for (int col = 0; col < w; col++) {
-                    term_write(" ");
-                }
+                screen_move_cursor(x, y + row);
+                screen_write_repeat(" ", w);
             }
 
             // Draw top border
-            term_move_cursor(x, y);
-            term_write("+");
-            for (int col = 1; col < w - 1; col++) {
-                term_write("-");
-            }
-            term_write("+");
+            screen_move_cursor(x, y);
+            screen_write("+");
+            screen_write_repeat("-", w - 2);
+            screen_write("+");
 
             // Draw title if present
             if (data->title) {
-                term_move_cursor(x + 2, y + 1);
-                term_write(data->title);
+                screen_move_cursor(x + 2, y + 1);
+                screen_write(data->title);
 
                 // Draw side borders for title row
-                term_move_cursor(x, y + 1);
-                term_write("|");
-                term_move_cursor(x + w - 1, y + 1);
-                term_write("|");
+                screen_move_cursor(x, y + 1);
+                screen_write("|");
+                screen_move_cursor(x + w - 1, y + 1);
+                screen_write("|");
             }
 
             // Render content
@@ -387,19 +435,17 @@ void render_component(struct component_t* component) {
             // Draw side borders for all content rows
             int start_row = data->title ? 2 : 1;
             for (int row = start_row; row < h - 1; row++) {
-                term_move_cursor(x, y + row);
-                term_write("|");
-                term_move_cursor(x + w - 1, y + row);
-                term_write("|");
+                screen_move_cursor(x, y + row);
+                screen_write("|");
+                screen_move_cursor(x + w - 1, y + row);
+                screen_write("|");
             }
 
             // Draw bottom border
-            term_move_cursor(x, y + h - 1);
-            term_write("+");
-            for (int col = 1; col < w - 1; col++) {
-                term_write("-");
-            }
-            term_write("+");
+            screen_move_cursor(x, y + h - 1);
+            screen_write("+");
+            screen_write_repeat("-", w - 2);
+            screen_write("+");
             break;
         }
 
@@ -410,77 +456,64 @@ void render_component(struct component_t* component) {
             int x = component->x;
             int y = component->y;
             int current_y = y;
+            int start, end;
 
             if (data->show_borders) {
                 // Top border
-                term_move_cursor(x, current_y++);
-                term_write("+");
+                screen_move_cursor(x, current_y++);
+                screen_write("+");
                 for (int col = 0; col < data->header_count; col++) {
-                    for (int i = 0; i < data->column_widths[col] + 2; i++) {
-                        term_write("-");
-                    }
-                    term_write("+");
+                    screen_write_repeat("-", data->column_widths[col] + 2);
+                    screen_write("+");
                 }
 
                 // Header row
-                term_move_cursor(x, current_y++);
-                term_write("|");
+                screen_move_cursor(x, current_y++);
+                screen_write("|");
                 for (int col = 0; col < data->header_count; col++) {
-                    term_write(" ");
+                    screen_write(" ");
                     write_padded(data->headers[col], data->column_widths[col]);
-                    term_write(" |");
+                    screen_write(" |");
                 }
 
                 // Separator
-                term_move_cursor(x, current_y++);
-                term_write("+");
+                screen_move_cursor(x, current_y++);
+                screen_write("+");
                 for (int col = 0; col < data->header_count; col++) {
-                    for (int i = 0; i < data->column_widths[col] + 2; i++) {
-                        term_write("-");
-                    }
-                    term_write("+");
+                    screen_write_repeat("-", data->column_widths[col] + 2);
+                    screen_write("+");
                 }
 
-                // Data rows
-                for (int row = 0; row < data->row_count; row++) {
-                    term_move_cursor(x, current_y++);
-                    term_write("|");
-                    for (int col = 0; col < data->header_count; col++) {
-                        term_write(" ");
-                        write_padded(data->rows[row][col], data->column_widths[col]);
-                        term_write(" |");
-                    }
+                // Data rows in view
+                table_get_visible_range(data, &start, &end);
+                for (int row = start; row < end; row++) {
+                    screen_move_cursor(x, current_y++);
+                    write_table_row(component, data, row);
                 }
             } else {
                 // Header row without borders
-                term_move_cursor(x, current_y++);
+                screen_move_cursor(x, current_y++);
                 for (int col = 0; col < data->header_count; col++) {
                     write_padded(data->headers[col], data->column_widths[col]);
                     if (col < data->header_count - 1) {
-                        term_write("  ");
+                        screen_write("  ");
                     }
                 }
 
                 // Separator line
-                term_move_cursor(x, current_y++);
+                screen_move_cursor(x, current_y++);
                 for (int col = 0; col < data->header_count; col++) {
-                    for (int i = 0; i < data->column_widths[col]; i++) {
-                        term_write("-");
-                    }
+                    screen_write_repeat("-", data->column_widths[col]);
                     if (col < data->header_count - 1) {
-                        term_write("  ");
+                        screen_write("  ");
                     }
                 }
 
-                // Data rows
-                for (int row = 0; row < data->row_count; row++) {
-                    term_move_cursor(x, current_y++);
-                    for (int col = 0; col < data->header_count; col++) {
-                        write_padded(data->rows[row][col], data->column_widths[col]);
-                        if (col < data->header_count - 1) {
-                            term_write("  ");
-                        }
-                    }
+                // Data rows in view
+                table_get_visible_range(data, &start, &end);
+                for (int row = start; row < end; row++) {
+                    screen_move_cursor(x, current_y++);
+                    write_table_row(component, data, row);
                 }
             }
             break;
@@ -524,13 +557,13 @@ void render_component(struct component_t* component) {
 
                 data->frame_index = (data->frame_index + 1) % frame_count;
                 data->last_update_time_us = now;
-
-                // Request re-render for next frame
-                tui_request_render();
             }
 
+            // Wake up for the next spinner frame
+            redraw_at(component, data->last_update_time_us + (uint64_t)data->speed_ms * 1000);
+
             // Render current frame
-            term_move_cursor(component->x, component->y);
+            screen_move_cursor(component->x, component->y);
 
             // Get the appropriate frame
             const char* frame = NULL;
@@ -563,19 +596,19 @@ void render_component(struct component_t* component) {
             }
 
             if (frame) {
-                term_write(frame);
+                screen_write(frame);
 
                 // Render text if present
                 if (data->text) {
-                    term_write(" ");
-                    term_write(data->text);
+                    screen_write(" ");
+                    screen_write(data->text);
                 }
 
                 // Render progress if present
                 if (data->progress) {
                     char progress_str[32];
                     snprintf(progress_str, sizeof(progress_str), " %.1f%%", *data->progress);
-                    term_write(progress_str);
+                    screen_write(progress_str);
                 }
             }
             break;
@@ -593,60 +626,33 @@ void render_component(struct component_t* component) {
             }
 
             int term_width, term_height;
-            tui_get_terminal_size(&term_width, &term_height);
-
-            // Calculate toast dimensions
-            int msg_len = strlen(data->message);
-            int toast_width = msg_len + 4;  // +4 for borders and padding
-            int toast_height = 3;  // Top border, message, bottom border
-
-            // Calculate position based on position type
-            int toast_x, toast_y;
-            switch (data->position) {
-                case TOAST_TOP:
-                    toast_x = (term_width - toast_width) / 2;
-                    toast_y = 1;
-                    break;
-                case TOAST_BOTTOM:
-                    toast_x = (term_width - toast_width) / 2;
-                    toast_y = term_height - toast_height - 1;
-                    break;
-                case TOAST_TOP_RIGHT:
-                    toast_x = term_width - toast_width - 2;
-                    toast_y = 1;
-                    break;
-                case TOAST_BOTTOM_RIGHT:
-                    toast_x = term_width - toast_width - 2;
-                    toast_y = term_height - toast_height - 1;
-                    break;
-            }
+            screen_get_size(&term_width, &term_height);
+
+            int toast_x, toast_y, toast_width, toast_height;
+            toast_get_rect(data, term_width, term_height, &toast_x, &toast_y, &toast_width, &toast_height);
 
             // Draw toast background and border
             for (int row = 0; row < toast_height; row++) {
                 int y = toast_y + row;
                 if (y < 0 || y >= term_height) continue;
 
-                term_move_cursor(toast_x, y);
+                screen_move_cursor(toast_x, y);
 
                 if (row == 0) {
                     // Top border
-                    term_write("+");
-                    for (int i = 0; i < toast_width - 2; i++) {
-                        term_write("-");
-                    }
-                    term_write("+");
+                    screen_write("+");
+                    screen_write_repeat("-", toast_width - 2);
+                    screen_write("+");
                 } else if (row == toast_height - 1) {
                     // Bottom border
-                    term_write("+");
-                    for (int i = 0; i < toast_width - 2; i++) {
-                        term_write("-");
-                    }
-                    term_write("+");
+                    screen_write("+");
+                    screen_write_repeat("-", toast_width - 2);
+                    screen_write("+");
                 } else {
                     // Message row
-                    term_write("| ");
-                    term_write(data->message);
-                    term_write(" |");
+                    screen_write("| ");
+                    screen_write(data->message);
+                    screen_write(" |");
                 }
             }
             break;
@@ -667,6 +673,7 @@ void render_component(struct component_t* component) {
 
         case COMPONENT_VSTACK:
         case COMPONENT_HSTACK:
+        case COMPONENT_MEMO:
             for (int i = 0; i < component->child_count; i++) {
                 render_component(component->children[i]);
             }
@@ -675,6 +682,6 @@ void render_component(struct component_t* component) {
 
     // Reset styling after rendering
     if (has_style) {
-        term_reset_style();
+        screen_reset_style();
     }
 }
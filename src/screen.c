@@ -0,0 +1,646 @@
+#include "internal/screen.h"
+#include "internal/terminal.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Back buffer (being drawn) and front buffer (what the terminal shows)
+static screen_cell_t* back_cells = NULL;
+static screen_cell_t* front_cells = NULL;
+static int screen_width = 0;
+static int screen_height = 0;
+static bool front_valid = false;
+
+// Row hashes of the back and front buffers, for spotting scrolled rows
+static uint32_t* back_hashes = NULL;
+static uint32_t* front_hashes = NULL;
+
+// Draw position and pen used by screen_write()
+static int draw_x = 0;
+static int draw_y = 0;
+static color_t pen_fg = COLOR_DEFAULT;
+static color_t pen_bg = COLOR_DEFAULT;
+static style_t pen_style = STYLE_NONE;
+
+// Damage beyond this many rectangles is merged into their bounding box
+#define MAX_DAMAGE_RECTS 16
+
+typedef struct {
+    int x, y;
+    int width, height;
+} damage_rect_t;
+
+typedef struct {
+    damage_rect_t rects[MAX_DAMAGE_RECTS];
+    int count;
+    bool full;  // Covers the whole screen; rects is unused
+} damage_t;
+
+// Damage for the next frame, and damage of the frame being drawn
+static damage_t pending_damage = { .full = true };
+static damage_t frame_damage = { .full = true };
+
+static const screen_cell_t blank_cell = { {' ', 0, 0, 0}, 1, COLOR_DEFAULT, COLOR_DEFAULT, STYLE_NONE };
+
+static void fill_blank(screen_cell_t* cells, int count) {
+    for (int i = 0; i < count; i++) {
+        cells[i] = blank_cell;
+    }
+}
+
+bool screen_init(int width, int height) {
+    return screen_resize(width, height);
+}
+
+void screen_free(void) {
+    free(back_cells);
+    free(front_cells);
+    free(back_hashes);
+    free(front_hashes);
+    back_cells = NULL;
+    front_cells = NULL;
+    back_hashes = NULL;
+    front_hashes = NULL;
+    screen_width = 0;
+    screen_height = 0;
+    front_valid = false;
+}
+
+bool screen_resize(int width, int height) {
+    if (width < 0) width = 0;
+    if (height < 0) height = 0;
+
+    size_t count = (size_t)width * (size_t)height;
+    screen_cell_t* new_back = malloc((count ? count : 1) * sizeof(screen_cell_t));
+    screen_cell_t* new_front = malloc((count ? count : 1) * sizeof(screen_cell_t));
+    uint32_t* new_back_hashes = malloc((height ? height : 1) * sizeof(uint32_t));
+    uint32_t* new_front_hashes = malloc((height ? height : 1) * sizeof(uint32_t));
+    if (!new_back || !new_front || !new_back_hashes || !new_front_hashes) {
+        free(new_back);
+        free(new_front);
+        free(new_back_hashes);
+        free(new_front_hashes);
+        return false;
+    }
+
+    free(back_cells);
+    free(front_cells);
+    free(back_hashes);
+    free(front_hashes);
+    back_cells = new_back;
+    front_cells = new_front;
+    back_hashes = new_back_hashes;
+    front_hashes = new_front_hashes;
+    screen_width = width;
+    screen_height = height;
+
+    fill_blank(back_cells, (int)count);
+    front_valid = false;
+    screen_damage_all();
+    return true;
+}
+
+void screen_get_size(int* width, int* height) {
+    if (width) *width = screen_width;
+    if (height) *height = screen_height;
+}
+
+void screen_invalidate(void) {
+    front_valid = false;
+}
+
+void screen_clear(void) {
+    fill_blank(back_cells, screen_width * screen_height);
+    screen_reset_style();
+    draw_x = 0;
+    draw_y = 0;
+}
+
+static bool rect_contains(const damage_rect_t* outer, const damage_rect_t* inner) {
+    return inner->x >= outer->x && inner->y >= outer->y &&
+           inner->x + inner->width <= outer->x + outer->width &&
+           inner->y + inner->height <= outer->y + outer->height;
+}
+
+static bool rect_overlaps(const damage_rect_t* a, int x, int y, int width, int height) {
+    return x < a->x + a->width && a->x < x + width &&
+           y < a->y + a->height && a->y < y + height;
+}
+
+/**
+ * Grow a rectangle to cover another one as well
+ */
+static void rect_union(damage_rect_t* rect, const damage_rect_t* other) {
+    int right = rect->x + rect->width;
+    int bottom = rect->y + rect->height;
+    if (other->x + other->width > right) right = other->x + other->width;
+    if (other->y + other->height > bottom) bottom = other->y + other->height;
+    if (other->x < rect->x) rect->x = other->x;
+    if (other->y < rect->y) rect->y = other->y;
+    rect->width = right - rect->x;
+    rect->height = bottom - rect->y;
+}
+
+void screen_damage(int x, int y, int width, int height) {
+    if (pending_damage.full) {
+        return;
+    }
+
+    // Clip to the buffer
+    if (x < 0) { width += x; x = 0; }
+    if (y < 0) { height += y; y = 0; }
+    if (x + width > screen_width) width = screen_width - x;
+    if (y + height > screen_height) height = screen_height - y;
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+    if (width == screen_width && height == screen_height) {
+        screen_damage_all();
+        return;
+    }
+
+    damage_rect_t rect = { x, y, width, height };
+
+    // Drop whichever of the new and existing rectangles the other covers
+    int kept = 0;
+    for (int i = 0; i < pending_damage.count; i++) {
+        if (rect_contains(&pending_damage.rects[i], &rect)) {
+            return;
+        }
+        if (!rect_contains(&rect, &pending_damage.rects[i])) {
+            pending_damage.rects[kept++] = pending_damage.rects[i];
+        }
+    }
+    pending_damage.count = kept;
+
+    if (pending_damage.count == MAX_DAMAGE_RECTS) {
+        for (int i = 0; i < pending_damage.count; i++) {
+            rect_union(&rect, &pending_damage.rects[i]);
+        }
+        pending_damage.count = 0;
+    }
+    pending_damage.rects[pending_damage.count++] = rect;
+}
+
+void screen_damage_all(void) {
+    pending_damage.full = true;
+    pending_damage.count = 0;
+}
+
+void screen_begin_frame(void) {
+    frame_damage = pending_damage;
+    pending_damage.full = false;
+    pending_damage.count = 0;
+
+    if (frame_damage.full) {
+        fill_blank(back_cells, screen_width * screen_height);
+    } else {
+        for (int i = 0; i < frame_damage.count; i++) {
+            const damage_rect_t* rect = &frame_damage.rects[i];
+            for (int row = rect->y; row < rect->y + rect->height; row++) {
+                fill_blank(&back_cells[row * screen_width + rect->x], rect->width);
+            }
+        }
+    }
+
+    screen_reset_style();
+    draw_x = 0;
+    draw_y = 0;
+}
+
+bool screen_is_damaged(int x, int y, int width, int height) {
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+    if (frame_damage.full) {
+        return true;
+    }
+    for (int i = 0; i < frame_damage.count; i++) {
+        if (rect_overlaps(&frame_damage.rects[i], x, y, width, height)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void screen_move_cursor(int x, int y) {
+    draw_x = x;
+    draw_y = y;
+}
+
+/**
+ * Length of a UTF-8 sequence from its lead byte
+ * Stray continuation bytes are treated as single-byte characters
+ */
+static int utf8_sequence_length(unsigned char lead) {
+    if (lead < 0x80) return 1;
+    if ((lead & 0xE0) == 0xC0) return 2;
+    if ((lead & 0xF0) == 0xE0) return 3;
+    if ((lead & 0xF8) == 0xF0) return 4;
+    return 1;
+}
+
+/**
+ * Store one character at the draw position and advance it
+ */
+static void put_glyph(const unsigned char* glyph, int len) {
+    if (draw_x >= 0 && draw_x < screen_width && draw_y >= 0 && draw_y < screen_height &&
+        screen_is_damaged(draw_x, draw_y, 1, 1)) {
+        screen_cell_t* cell = &back_cells[draw_y * screen_width + draw_x];
+        memset(cell->glyph, 0, sizeof(cell->glyph));
+        memcpy(cell->glyph, glyph, len);
+        cell->glyph_len = (uint8_t)len;
+        cell->fg = (uint8_t)pen_fg;
+        cell->bg = (uint8_t)pen_bg;
+        cell->style = (uint8_t)pen_style;
+    }
+
+    draw_x++;
+}
+
+/**
+ * Length of the UTF-8 character at p, stopping at the terminator on
+ * truncated sequences
+ */
+static int glyph_length(const unsigned char* p) {
+    int len = utf8_sequence_length(*p);
+    int available = 1;
+    while (available < len && p[available]) {
+        available++;
+    }
+    return available;
+}
+
+void screen_write(const char* str) {
+    if (!str || !back_cells) {
+        return;
+    }
+
+    const unsigned char* p = (const unsigned char*)str;
+    while (*p) {
+        int len = glyph_length(p);
+
+        // Control characters have no cell of their own
+        if (*p >= 0x20 && *p != 0x7F) {
+            put_glyph(p, len);
+        }
+        p += len;
+    }
+}
+
+void screen_write_repeat(const char* glyph, int count) {
+    if (!glyph || !*glyph || !back_cells) {
+        return;
+    }
+
+    const unsigned char* p = (const unsigned char*)glyph;
+    if (*p < 0x20 || *p == 0x7F) {
+        return;
+    }
+
+    int len = glyph_length(p);
+    for (int i = 0; i < count; i++) {
+        put_glyph(p, len);
+    }
+}
+
+void screen_set_color(color_t fg, color_t bg) {
+    if (fg != COLOR_DEFAULT) {
+        pen_fg = fg;
+    }
+    if (bg != COLOR_DEFAULT) {
+        pen_bg = bg;
+    }
+}
+
+void screen_set_style(style_t style) {
+    pen_style |= style;
+}
+
+void screen_reset_style(void) {
+    pen_fg = COLOR_DEFAULT;
+    pen_bg = COLOR_DEFAULT;
+    pen_style = STYLE_NONE;
+}
+
+const screen_cell_t* screen_get_cell(int x, int y) {
+    if (x < 0 || x >= screen_width || y < 0 || y >= screen_height) {
+        return NULL;
+    }
+    return &back_cells[y * screen_width + x];
+}
+
+static bool same_pen(const screen_cell_t* a, const screen_cell_t* b) {
+    return a->fg == b->fg && a->bg == b->bg && a->style == b->style;
+}
+
+/**
+ * Try to reach column x on the cursor's row by rewriting the cells in
+ * between, which are already correct on screen
+ * Only done when the cells use the current pen and cost fewer bytes than
+ * a cursor move. Returns true if the cursor was advanced.
+ */
+static bool rewrite_gap(int from_x, int x, int y, const screen_cell_t* pen) {
+    if (from_x < 0 || from_x >= x) {
+        return false;
+    }
+
+    int move_cost = term_cursor_move_cost(x, y);
+    int gap_cost = 0;
+    for (int i = from_x; i < x; i++) {
+        const screen_cell_t* cell = &front_cells[y * screen_width + i];
+        if (!same_pen(cell, pen)) {
+            return false;
+        }
+        gap_cost += cell->glyph_len;
+        if (gap_cost >= move_cost) {
+            return false;
+        }
+    }
+
+    for (int i = from_x; i < x; i++) {
+        const screen_cell_t* cell = &front_cells[y * screen_width + i];
+        term_write_len(cell->glyph, cell->glyph_len);
+    }
+    return true;
+}
+
+/**
+ * Hash a row of cells (FNV-1a)
+ */
+static uint32_t hash_row(const screen_cell_t* cells) {
+    const unsigned char* bytes = (const unsigned char*)cells;
+    size_t size = (size_t)screen_width * sizeof(screen_cell_t);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Number of cells that differ between a back row and a front row
+ */
+static int count_changed_cells(const screen_cell_t* back, const screen_cell_t* front) {
+    int changed = 0;
+    for (int x = 0; x < screen_width; x++) {
+        if (memcmp(&back[x], &front[x], sizeof(screen_cell_t)) != 0) {
+            changed++;
+        }
+    }
+    return changed;
+}
+
+/**
+ * Cells left to send in rows top..bottom if the front buffer were
+ * scrolled by amount (positive moves the contents up)
+ */
+static int count_changed_after_scroll(int top, int bottom, int amount) {
+    int changed = 0;
+    for (int y = top; y <= bottom; y++) {
+        int source = y + amount;
+        if (source >= top && source <= bottom) {
+            changed += count_changed_cells(&back_cells[y * screen_width],
+                                           &front_cells[source * screen_width]);
+        } else {
+            // Scrolled in blank
+            for (int x = 0; x < screen_width; x++) {
+                if (memcmp(&back_cells[y * screen_width + x], &blank_cell, sizeof(screen_cell_t)) != 0) {
+                    changed++;
+                }
+            }
+        }
+    }
+    return changed;
+}
+
+/**
+ * Find the scroll that puts the most rows of rows first..last - 1 in
+ * place: the longest run of back rows matching front rows shifted by the
+ * same amount, counting only rows that don't match already
+ * Returns false if no rows would be put in place.
+ */
+static bool find_scroll(int first_row, int last_row, int* top, int* bottom, int* amount) {
+    int best_gain = 0;
+
+    for (int shift = first_row - last_row + 1; shift < last_row - first_row; shift++) {
+        if (shift == 0) {
+            continue;
+        }
+
+        int start = shift > 0 ? first_row : first_row - shift;
+        int end = shift > 0 ? last_row - shift : last_row;
+        int run_start = start;
+        int gain = 0;
+
+        for (int y = start; y <= end; y++) {
+            if (y < end && back_hashes[y] == front_hashes[y + shift]) {
+                if (back_hashes[y] != front_hashes[y]) {
+                    gain++;
+                }
+                continue;
+            }
+
+            // Run of rows run_start..y - 1 ends here
+            if (gain > best_gain) {
+                best_gain = gain;
+                *amount = shift;
+                *top = shift > 0 ? run_start : run_start + shift;
+                *bottom = shift > 0 ? y - 1 + shift : y - 1;
+            }
+            run_start = y + 1;
+            gain = 0;
+        }
+    }
+
+    return best_gain > 0;
+}
+
+/**
+ * Scroll regions of the terminal whose contents moved vertically, so
+ * only the lines scrolled in have to be drawn
+ * Regions span whole rows, since scroll margins are only vertical.
+ */
+static void scroll_moved_rows(int first_row, int last_row) {
+    for (int y = first_row; y < last_row; y++) {
+        back_hashes[y] = hash_row(&back_cells[y * screen_width]);
+        front_hashes[y] = hash_row(&front_cells[y * screen_width]);
+    }
+
+    // Each pass scrolls one region; a few cover independently scrolling panes
+    for (int pass = 0; pass < 4; pass++) {
+        int top, bottom, amount;
+        if (!find_scroll(first_row, last_row, &top, &bottom, &amount)) {
+            return;
+        }
+
+        int before = 0;
+        for (int y = top; y <= bottom; y++) {
+            before += count_changed_cells(&back_cells[y * screen_width], &front_cells[y * screen_width]);
+        }
+        int after = count_changed_after_scroll(top, bottom, amount);
+
+        // Scrolling homes the cursor, so count a move back as well
+        int cost = term_scroll_region_cost(top, bottom, amount) + term_cursor_move_cost(screen_width / 2, top);
+        if (before - after <= cost) {
+            return;
+        }
+
+        term_scroll_region(top, bottom, amount);
+
+        // The front buffer follows the terminal
+        int rows = bottom - top + 1;
+        int moved = rows - (amount > 0 ? amount : -amount);
+        size_t row_size = (size_t)screen_width * sizeof(screen_cell_t);
+        if (amount > 0) {
+            memmove(&front_cells[top * screen_width], &front_cells[(top + amount) * screen_width],
+                    moved * row_size);
+            memmove(&front_hashes[top], &front_hashes[top + amount], moved * sizeof(uint32_t));
+            for (int y = top + moved; y <= bottom; y++) {
+                fill_blank(&front_cells[y * screen_width], screen_width);
+                front_hashes[y] = hash_row(&front_cells[y * screen_width]);
+            }
+        } else {
+            memmove(&front_cells[(top - amount) * screen_width], &front_cells[top * screen_width],
+                    moved * row_size);
+            memmove(&front_hashes[top - amount], &front_hashes[top], moved * sizeof(uint32_t));
+            for (int y = top; y < top - amount; y++) {
+                fill_blank(&front_cells[y * screen_width], screen_width);
+                front_hashes[y] = hash_row(&front_cells[y * screen_width]);
+            }
+        }
+    }
+}
+
+/**
+ * Check whether erasing gives a cell its look
+ * Erased cells are spaces without underline in the current background.
+ * Only the default background is trusted, since some terminals erase to
+ * it whatever the pen says.
+ */
+static bool is_erasable(const screen_cell_t* cell) {
+    return cell->glyph_len == 1 && cell->glyph[0] == ' ' &&
+           cell->bg == COLOR_DEFAULT && !(cell->style & STYLE_UNDERLINE);
+}
+
+/**
+ * Send the changed cell at (x, y) with the cursor and pen already there,
+ * along with the cells after it when they form a run
+ * Runs of blanks are erased (EL, ECH) and runs of one character repeated
+ * (REP) when that is shorter than writing them out. Returns the number of
+ * cells sent and sets *cursor_x to where the cursor is left.
+ */
+static int present_run(int x, int y, int* cursor_x) {
+    screen_cell_t* back = &back_cells[y * screen_width];
+    screen_cell_t* front = &front_cells[y * screen_width];
+    const screen_cell_t* cell = &back[x];
+    int count = 1;
+
+    if (is_erasable(cell)) {
+        int end = x;
+        int changed = 0;
+        while (end < screen_width && is_erasable(&back[end])) {
+            if (memcmp(&back[end], &front[end], sizeof(screen_cell_t)) != 0) {
+                changed++;
+            }
+            end++;
+        }
+
+        // The cursor stays put, so erasing part of a row costs a move past it
+        int erase_cost = end == screen_width ? 3  // ESC [ K
+                       : term_erase_chars_cost(end - x) + term_cursor_move_cost(end, y);
+        if (changed > erase_cost) {
+            if (end == screen_width) {
+                term_erase_line();
+            } else {
+                term_erase_chars(end - x);
+            }
+            memcpy(&front[x], &back[x], (end - x) * sizeof(screen_cell_t));
+            *cursor_x = x;
+            return end - x;
+        }
+    }
+
+    // Changed cells identical to this one
+    while (x + count < screen_width &&
+           memcmp(&back[x + count], cell, sizeof(screen_cell_t)) == 0 &&
+           memcmp(&back[x + count], &front[x + count], sizeof(screen_cell_t)) != 0) {
+        count++;
+    }
+
+    term_write_repeated(cell->glyph, cell->glyph_len, count);
+    for (int i = 0; i < count; i++) {
+        front[x + i] = *cell;
+    }
+    *cursor_x = x + count;
+    return count;
+}
+
+void screen_present(void) {
+    if (!back_cells) {
+        return;
+    }
+
+    int count = screen_width * screen_height;
+
+    // Blank cells are drawn with the default pen, so start from it
+    term_reset_style();
+
+    // Cells outside the damage weren't drawn, so they still match
+    int first_row = 0;
+    int last_row = screen_height;
+    bool cleared = !front_valid;
+    if (!front_valid) {
+        // Terminal contents are unknown: clear it and diff against blanks
+        term_clear();
+        fill_blank(front_cells, count);
+        front_valid = true;
+    } else if (!frame_damage.full) {
+        first_row = screen_height;
+        last_row = 0;
+        for (int i = 0; i < frame_damage.count; i++) {
+            const damage_rect_t* rect = &frame_damage.rects[i];
+            if (rect->y < first_row) first_row = rect->y;
+            if (rect->y + rect->height > last_row) last_row = rect->y + rect->height;
+        }
+    }
+
+    // Rows that only moved are scrolled rather than drawn again. With the
+    // terminal contents unknown there is nothing to scroll.
+    if (!cleared && last_row - first_row > 1) {
+        scroll_moved_rows(first_row, last_row);
+    }
+
+    // Pen of the last cell written; the terminal layer skips redundant SGR
+    screen_cell_t current_pen = blank_cell;
+    int cursor_x = -1;  // Column after the last cell written, -1 if unknown
+    int cursor_y = -1;
+
+    for (int y = first_row; y < last_row; y++) {
+        int x = 0;
+        while (x < screen_width) {
+            int index = y * screen_width + x;
+            const screen_cell_t* cell = &back_cells[index];
+
+            if (memcmp(cell, &front_cells[index], sizeof(screen_cell_t)) == 0) {
+                x++;
+                continue;
+            }
+
+            // Reposition unless this cell follows the last one written, or
+            // the unchanged cells in between are cheaper to rewrite
+            if (cursor_x != x || cursor_y != y) {
+                if (cursor_y != y || !rewrite_gap(cursor_x, x, y, &current_pen)) {
+                    term_move_cursor(x, y);
+                }
+                cursor_y = y;
+            }
+
+            term_set_pen((color_t)cell->fg, (color_t)cell->bg, (style_t)cell->style);
+            current_pen = *cell;
+
+            x += present_run(x, y, &cursor_x);
+        }
+    }
+
+    term_reset_style();
+}
@@ -1,10 +1,8 @@
 #include "internal/terminal.h"
-#include <stdio.h>
+#include "internal/backend.h"
 #include <stdlib.h>
 #include <string.h>
-#include <unistd.h>
-#include <termios.h>
-#include <sys/ioctl.h>
+#include <errno.h>
 
 // ANSI escape codes
 #define ANSI_CLEAR "\033[2J"
@@ -13,46 +11,136 @@
 #define ANSI_SHOW_CURSOR "\033[?25h"
 #define ANSI_ALT_BUFFER "\033[?1049h"
 #define ANSI_MAIN_BUFFER "\033[?1049l"
+#define ANSI_SYNC_BEGIN "\033[?2026h"
+#define ANSI_SYNC_END "\033[?2026l"
+#define ANSI_SYNC_QUERY "\033[?2026$p"  // DECRQM: is mode 2026 recognized?
+#define ANSI_PASTE_ON "\033[?2004h"     // Bracket pasted text with ESC[200~ / ESC[201~
+#define ANSI_PASTE_OFF "\033[?2004l"
+#define ANSI_ERASE_LINE "\033[K"
+
+// Frame output buffer: everything sent to the terminal is collected here
+// and written with a single write() per flush
+#define OUTPUT_BUFFER_INITIAL_SIZE 16384
+
+static char* output_buffer = NULL;
+static size_t output_length = 0;
+static size_t output_capacity = 0;
+static term_output_stats_t output_stats = {0};
+
+// Whether the terminal answered the DECRQM probe for mode 2026
+static bool sync_update_supported = false;
+
+// Whether REP (repeat preceding character) can be used; the backend
+// decides, as terminals don't report it
+static bool repeat_supported = false;
+
+// Mouse reporting; motion without a button held wakes the loop on every
+// movement, so it's only reported when asked for
+static bool mouse_enabled = false;
+static bool mouse_motion = false;
+
+// Cursor position on the terminal; unknown until the first absolute move
+static bool cursor_known = false;
+static int cursor_x = 0;
+static int cursor_y = 0;
+static int known_width = 0;   // Last width reported by term_get_size()
+static int known_height = 0;  // Last height reported by term_get_size()
+
+// Pen (SGR state) currently active on the terminal; unknown until first set
+static bool pen_known = false;
+static color_t pen_fg = COLOR_DEFAULT;
+static color_t pen_bg = COLOR_DEFAULT;
+static style_t pen_style = STYLE_NONE;
+
+// SGR parameters for every color_t value, indexed by color
+// COLOR_DEFAULT maps to 39/49, COLOR_BLACK..COLOR_WHITE to 30-37/40-47,
+// and the bright colors to 90-97/100-107
+static const char* const sgr_fg_params[] = {
+    "39",
+    "30", "31", "32", "33", "34", "35", "36", "37",
+    "90", "91", "92", "93", "94", "95", "96", "97",
+};
+
+static const char* const sgr_bg_params[] = {
+    "49",
+    "40", "41", "42", "43", "44", "45", "46", "47",
+    "100", "101", "102", "103", "104", "105", "106", "107",
+};
+
+/**
+ * Write bytes straight to the backend, retrying on partial writes
+ */
+static void write_all(const char* data, size_t len) {
+    const backend_t* backend = backend_get();
+    while (len > 0) {
+        ssize_t written = backend->write(data, len);
+        output_stats.syscalls++;
+        if (written < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            return;
+        }
+        output_stats.bytes += (unsigned long)written;
+        data += written;
+        len -= (size_t)written;
+    }
+}
 
-// Original terminal settings to restore on cleanup
-static struct termios original_termios;
-static bool termios_saved = false;
-
-bool term_init(void) {
-    // Save current terminal settings
-    if (tcgetattr(STDIN_FILENO, &original_termios) == -1) {
-        perror("tcgetattr");
-        return false;
+/**
+ * Make room for at least extra more bytes in the output buffer
+ * Returns false if the buffer couldn't grow
+ */
+static bool output_reserve(size_t extra) {
+    if (output_length + extra <= output_capacity) {
+        return true;
     }
-    termios_saved = true;
 
-    // Configure terminal for raw mode
-    struct termios raw = original_termios;
+    size_t new_capacity = output_capacity == 0 ? OUTPUT_BUFFER_INITIAL_SIZE : output_capacity;
+    while (new_capacity < output_length + extra) {
+        new_capacity *= 2;
+    }
 
-    // Disable canonical mode (line buffering) and echo
-    raw.c_lflag &= ~(ECHO | ICANON | ISIG | IEXTEN);
+    char* new_buffer = realloc(output_buffer, new_capacity);
+    if (!new_buffer) {
+        return false;
+    }
+    output_buffer = new_buffer;
+    output_capacity = new_capacity;
+    return true;
+}
 
-    // Disable input processing
-    raw.c_iflag &= ~(IXON | ICRNL | BRKINT | INPCK | ISTRIP);
+/**
+ * Queue raw bytes (escape sequences) without touching the cursor tracker
+ */
+static void output_append(const char* data, size_t len) {
+    if (len == 0) {
+        return;
+    }
 
-    // Disable output processing
-    raw.c_oflag &= ~(OPOST);
+    if (!output_reserve(len)) {
+        // Out of memory: fall back to unbuffered output
+        term_flush();
+        write_all(data, len);
+        return;
+    }
 
-    // Set character size to 8 bits
-    raw.c_cflag |= (CS8);
+    memcpy(output_buffer + output_length, data, len);
+    output_length += len;
+}
 
-    // Read returns immediately with any data
-    raw.c_cc[VMIN] = 0;
-    raw.c_cc[VTIME] = 1;
+static void output_append_str(const char* str) {
+    output_append(str, strlen(str));
+}
 
-    // Apply settings
-    if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw) == -1) {
-        perror("tcsetattr");
+bool term_init(void) {
+    // Raw mode
+    if (!backend_get()->init()) {
         return false;
     }
 
     // Switch to alternate screen buffer
-    term_write(ANSI_ALT_BUFFER);
+    output_append_str(ANSI_ALT_BUFFER);
 
     // Hide cursor
     term_hide_cursor();
@@ -60,135 +148,548 @@ bool term_init(void) {
     // Enable mouse tracking
     term_enable_mouse();
 
+    // Have pastes arrive as one block instead of as typed keys
+    output_append_str(ANSI_PASTE_ON);
+
+    // Start from a known pen
+    pen_known = false;
+    term_reset_style();
+
     // Clear screen
     term_clear();
 
+    // Ask whether synchronized updates are supported; the reply arrives as
+    // input and is handled by event_poll(). Until then frames go out unbracketed.
+    sync_update_supported = false;
+    output_append_str(ANSI_SYNC_QUERY);
+    repeat_supported = backend_get()->supports_repeat();
+    term_flush();
+
     return true;
 }
 
 void term_cleanup(void) {
+    // Leave the shell with default colors
+    term_reset_style();
+
     // Disable mouse tracking
     term_disable_mouse();
+    output_append_str(ANSI_PASTE_OFF);
 
     // Show cursor
     term_show_cursor();
 
     // Switch back to main screen buffer
-    term_write(ANSI_MAIN_BUFFER);
+    output_append_str(ANSI_MAIN_BUFFER);
+    term_flush();
 
-    // Restore original terminal settings
-    if (termios_saved) {
-        tcsetattr(STDIN_FILENO, TCSAFLUSH, &original_termios);
-        termios_saved = false;
-    }
+    pen_known = false;
+    cursor_known = false;
+
+    free(output_buffer);
+    output_buffer = NULL;
+    output_length = 0;
+    output_capacity = 0;
+
+    // Restore the original terminal mode
+    backend_get()->cleanup();
 }
 
 void term_clear(void) {
-    term_write(ANSI_CLEAR);
-    term_write(ANSI_HOME);
+    output_append_str(ANSI_CLEAR);
+    output_append_str(ANSI_HOME);
+
+    cursor_known = true;
+    cursor_x = 0;
+    cursor_y = 0;
+}
+
+/**
+ * Format a non-negative integer, returns the number of characters written
+ */
+static int format_uint(char* buf, int value) {
+    char digits[12];
+    int count = 0;
+    do {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+
+    for (int i = 0; i < count; i++) {
+        buf[i] = digits[count - 1 - i];
+    }
+    return count;
+}
+
+static int digit_count(int value) {
+    int count = 1;
+    while (value >= 10) {
+        value /= 10;
+        count++;
+    }
+    return count;
+}
+
+/**
+ * Build an absolute cursor position sequence (CUP)
+ * Row/column parameters equal to 1 are omitted
+ */
+static int build_absolute_move(char* buf, int x, int y) {
+    int len = 0;
+    buf[len++] = '\033';
+    buf[len++] = '[';
+    if (y > 0 || x > 0) {
+        len += format_uint(buf + len, y + 1);
+    }
+    if (x > 0) {
+        buf[len++] = ';';
+        len += format_uint(buf + len, x + 1);
+    }
+    buf[len++] = 'H';
+    return len;
+}
+
+/**
+ * Build a sequence with a single count: CSI n <final>, with n omitted when 1
+ * Used for relative moves along one axis, and for scrolling, erasing and
+ * repeating
+ */
+static int build_relative_move(char* buf, int amount, char final) {
+    int len = 0;
+    buf[len++] = '\033';
+    buf[len++] = '[';
+    if (amount > 1) {
+        len += format_uint(buf + len, amount);
+    }
+    buf[len++] = final;
+    return len;
+}
+
+static int relative_move_cost(int amount) {
+    return amount > 1 ? 3 + digit_count(amount) : 3;
+}
+
+/**
+ * Build the cheapest relative move from the tracked position
+ * Vertical: LF (plain line feed, output processing is off) or CUU/CUD
+ * Horizontal: CR, CR + CUF, BS, CUB or CUF
+ */
+static int build_relative(char* buf, int x, int y) {
+    int len = 0;
+
+    if (y > cursor_y) {
+        int down = y - cursor_y;
+        if (down <= relative_move_cost(down)) {
+            memset(buf, '\n', down);
+            len += down;
+        } else {
+            len += build_relative_move(buf, down, 'B');
+        }
+    } else if (y < cursor_y) {
+        len += build_relative_move(buf, cursor_y - y, 'A');
+    }
+
+    if (x == 0 && cursor_x != 0) {
+        buf[len++] = '\r';
+    } else if (x > cursor_x) {
+        int right = x - cursor_x;
+        int cuf_cost = relative_move_cost(right);
+        int cr_cost = 1 + relative_move_cost(x);
+        if (cr_cost < cuf_cost) {
+            buf[len++] = '\r';
+            len += build_relative_move(buf + len, x, 'C');
+        } else {
+            len += build_relative_move(buf + len, right, 'C');
+        }
+    } else if (x < cursor_x) {
+        int left = cursor_x - x;
+        int cub_cost = relative_move_cost(left);
+        int cr_cost = 1 + relative_move_cost(x);
+        if (left <= cub_cost && left <= cr_cost) {
+            memset(buf + len, '\b', left);
+            len += left;
+        } else if (cr_cost < cub_cost) {
+            buf[len++] = '\r';
+            len += build_relative_move(buf + len, x, 'C');
+        } else {
+            len += build_relative_move(buf + len, left, 'D');
+        }
+    }
+
+    return len;
+}
+
+/**
+ * Largest sequence build_relative() can produce: LF runs are capped by the
+ * CUD cost, so both axes fit in a few escape sequences
+ */
+#define CURSOR_MOVE_MAX 48
+
+/**
+ * Build the cheapest sequence that moves the cursor to (x, y)
+ */
+static int build_cursor_move(char* buf, int x, int y) {
+    char absolute[CURSOR_MOVE_MAX];
+    int absolute_len = build_absolute_move(absolute, x, y);
+
+    if (!cursor_known) {
+        memcpy(buf, absolute, absolute_len);
+        return absolute_len;
+    }
+
+    if (x == cursor_x && y == cursor_y) {
+        return 0;
+    }
+
+    int relative_len = build_relative(buf, x, y);
+    if (absolute_len < relative_len) {
+        memcpy(buf, absolute, absolute_len);
+        return absolute_len;
+    }
+    return relative_len;
 }
 
 void term_move_cursor(int x, int y) {
-    // ANSI uses 1-based indexing, we use 0-based
-    char buf[32];
-    snprintf(buf, sizeof(buf), "\033[%d;%dH", y + 1, x + 1);
-    term_write(buf);
+    if (x < 0) x = 0;
+    if (y < 0) y = 0;
+
+    char buf[CURSOR_MOVE_MAX];
+    int len = build_cursor_move(buf, x, y);
+    output_append(buf, len);
+
+    cursor_known = true;
+    cursor_x = x;
+    cursor_y = y;
+}
+
+int term_cursor_move_cost(int x, int y) {
+    if (x < 0) x = 0;
+    if (y < 0) y = 0;
+
+    char buf[CURSOR_MOVE_MAX];
+    return build_cursor_move(buf, x, y);
+}
+
+// DECSTBM with two 5-digit rows, SU/SD, and the DECSTBM reset
+#define SCROLL_REGION_MAX 32
+
+/**
+ * Build the scroll sequence for term_scroll_region()
+ * DECSTBM is left out when the region is the whole screen
+ */
+static int build_scroll_region(char* buf, int top, int bottom, int amount) {
+    bool whole_screen = top == 0 && bottom == known_height - 1;
+    int len = 0;
+
+    if (!whole_screen) {
+        buf[len++] = '\033';
+        buf[len++] = '[';
+        len += format_uint(buf + len, top + 1);
+        buf[len++] = ';';
+        len += format_uint(buf + len, bottom + 1);
+        buf[len++] = 'r';
+    }
+
+    len += build_relative_move(buf + len, amount > 0 ? amount : -amount, amount > 0 ? 'S' : 'T');
+
+    if (!whole_screen) {
+        // Back to the whole screen
+        buf[len++] = '\033';
+        buf[len++] = '[';
+        buf[len++] = 'r';
+    }
+    return len;
+}
+
+void term_scroll_region(int top, int bottom, int amount) {
+    if (amount == 0 || top >= bottom) {
+        return;
+    }
+
+    char buf[SCROLL_REGION_MAX];
+    int len = build_scroll_region(buf, top, bottom, amount);
+    output_append(buf, len);
+
+    // DECSTBM homes the cursor; SU/SD alone leave it where it was
+    if (!(top == 0 && bottom == known_height - 1)) {
+        cursor_known = true;
+        cursor_x = 0;
+        cursor_y = 0;
+    }
+}
+
+int term_scroll_region_cost(int top, int bottom, int amount) {
+    if (amount == 0 || top >= bottom) {
+        return 0;
+    }
+
+    char buf[SCROLL_REGION_MAX];
+    return build_scroll_region(buf, top, bottom, amount);
+}
+
+void term_invalidate_cursor(void) {
+    cursor_known = false;
 }
 
 void term_write(const char* str) {
-    write(STDOUT_FILENO, str, strlen(str));
+    term_write_len(str, strlen(str));
 }
 
-bool term_get_size(int* width, int* height) {
-    struct winsize ws;
+void term_write_len(const char* str, size_t len) {
+    output_append(str, len);
+
+    if (!cursor_known) {
+        return;
+    }
+
+    // Advance the tracked cursor by one column per code point; anything
+    // that isn't printable text leaves the position unknown
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)str[i];
+        if (c < 0x20 || c == 0x7F) {
+            cursor_known = false;
+            return;
+        }
+        if ((c & 0xC0) != 0x80) {
+            cursor_x++;
+        }
+    }
+
+    // At the right margin the terminal is in its pending-wrap state
+    if (known_width > 0 && cursor_x >= known_width) {
+        cursor_known = false;
+    }
+}
+
+void term_write_repeated(const char* glyph, size_t len, int count) {
+    if (count <= 0) {
+        return;
+    }
+
+    term_write_len(glyph, len);
+    if (count == 1) {
+        return;
+    }
+
+    if (!repeat_supported || relative_move_cost(count - 1) >= (int)len * (count - 1)) {
+        for (int i = 1; i < count; i++) {
+            term_write_len(glyph, len);
+        }
+        return;
+    }
+
+    char buf[16];
+    int buf_len = build_relative_move(buf, count - 1, 'b');
+    output_append(buf, buf_len);
+
+    if (cursor_known) {
+        cursor_x += count - 1;
+        if (known_width > 0 && cursor_x >= known_width) {
+            cursor_known = false;
+        }
+    }
+}
+
+void term_erase_chars(int count) {
+    if (count <= 0) {
+        return;
+    }
+
+    char buf[16];
+    int len = build_relative_move(buf, count, 'X');
+    output_append(buf, len);
+}
+
+int term_erase_chars_cost(int count) {
+    return count > 0 ? relative_move_cost(count) : 0;
+}
+
+void term_erase_line(void) {
+    output_append_str(ANSI_ERASE_LINE);
+}
+
+void term_flush(void) {
+    if (output_length == 0) {
+        return;
+    }
+    write_all(output_buffer, output_length);
+    output_length = 0;
+}
+
+void term_get_output_stats(term_output_stats_t* stats) {
+    if (stats) {
+        *stats = output_stats;
+    }
+}
+
+void term_reset_output_stats(void) {
+    output_stats.syscalls = 0;
+    output_stats.bytes = 0;
+}
 
-    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == -1) {
-        perror("ioctl");
+bool term_get_size(int* width, int* height) {
+    if (!backend_get()->get_size(width, height)) {
         return false;
     }
 
-    *width = ws.ws_col;
-    *height = ws.ws_row;
+    known_width = *width;
+    known_height = *height;
     return true;
 }
 
 void term_hide_cursor(void) {
-    term_write(ANSI_HIDE_CURSOR);
+    output_append_str(ANSI_HIDE_CURSOR);
 }
 
 void term_show_cursor(void) {
-    term_write(ANSI_SHOW_CURSOR);
+    output_append_str(ANSI_SHOW_CURSOR);
 }
 
 void term_set_color(color_t fg, color_t bg) {
-    char buf[64];
-    int offset = 0;
+    color_t new_fg = fg != COLOR_DEFAULT ? fg : (pen_known ? pen_fg : COLOR_DEFAULT);
+    color_t new_bg = bg != COLOR_DEFAULT ? bg : (pen_known ? pen_bg : COLOR_DEFAULT);
+    term_set_pen(new_fg, new_bg, pen_known ? pen_style : STYLE_NONE);
+}
 
-    buf[offset++] = '\033';
-    buf[offset++] = '[';
+void term_set_style(style_t style) {
+    if (pen_known) {
+        term_set_pen(pen_fg, pen_bg, pen_style | style);
+    } else {
+        term_set_pen(COLOR_DEFAULT, COLOR_DEFAULT, style);
+    }
+}
+
+/**
+ * Append an SGR parameter to the sequence being built
+ */
+static void sgr_append(char* buf, int* len, const char* param) {
+    if (*len > 2) {
+        buf[(*len)++] = ';';
+    }
+    size_t param_len = strlen(param);
+    memcpy(buf + *len, param, param_len);
+    *len += (int)param_len;
+}
 
-    bool need_semicolon = false;
+/**
+ * Build the SGR sequence that turns on the given pen starting from a reset
+ */
+static int sgr_build_from_reset(char* buf, color_t fg, color_t bg, style_t style) {
+    int len = 2;
+    sgr_append(buf, &len, "0");
+    if (style & STYLE_BOLD) sgr_append(buf, &len, "1");
+    if (style & STYLE_UNDERLINE) sgr_append(buf, &len, "4");
+    if (fg != COLOR_DEFAULT) sgr_append(buf, &len, sgr_fg_params[fg]);
+    if (bg != COLOR_DEFAULT) sgr_append(buf, &len, sgr_bg_params[bg]);
+    return len;
+}
 
-    if (fg != COLOR_DEFAULT) {
-        // COLOR_DEFAULT = 0, COLOR_BLACK = 1, ..., COLOR_WHITE = 8
-        // COLOR_BRIGHT_BLACK = 9, ..., COLOR_BRIGHT_WHITE = 16
-        // Map to ANSI: 0-7 (normal), 8-15 (bright)
-        int ansi_fg = fg - 1;  // Subtract 1 to get ANSI color value
-        if (ansi_fg <= 7) {
-            offset += snprintf(buf + offset, sizeof(buf) - offset, "3%d", ansi_fg);
-        } else {
-            offset += snprintf(buf + offset, sizeof(buf) - offset, "9%d", ansi_fg - 8);
-        }
-        need_semicolon = true;
+/**
+ * Build the SGR sequence that changes only what differs from the current pen
+ */
+static int sgr_build_delta(char* buf, color_t fg, color_t bg, style_t style) {
+    int len = 2;
+    style_t turned_on = style & ~pen_style;
+    style_t turned_off = pen_style & ~style;
+
+    if (turned_off & STYLE_BOLD) sgr_append(buf, &len, "22");
+    if (turned_off & STYLE_UNDERLINE) sgr_append(buf, &len, "24");
+    if (turned_on & STYLE_BOLD) sgr_append(buf, &len, "1");
+    if (turned_on & STYLE_UNDERLINE) sgr_append(buf, &len, "4");
+    if (fg != pen_fg) sgr_append(buf, &len, sgr_fg_params[fg]);
+    if (bg != pen_bg) sgr_append(buf, &len, sgr_bg_params[bg]);
+    return len;
+}
+
+void term_set_pen(color_t fg, color_t bg, style_t style) {
+    if (fg < COLOR_DEFAULT || fg > COLOR_BRIGHT_WHITE) fg = COLOR_DEFAULT;
+    if (bg < COLOR_DEFAULT || bg > COLOR_BRIGHT_WHITE) bg = COLOR_DEFAULT;
+    style &= (STYLE_BOLD | STYLE_UNDERLINE);
+
+    if (pen_known && fg == pen_fg && bg == pen_bg && style == pen_style) {
+        return;
     }
 
-    if (bg != COLOR_DEFAULT) {
-        if (need_semicolon) {
-            buf[offset++] = ';';
-        }
-        // Same mapping for background colors
-        int ansi_bg = bg - 1;  // Subtract 1 to get ANSI color value
-        if (ansi_bg <= 7) {
-            offset += snprintf(buf + offset, sizeof(buf) - offset, "4%d", ansi_bg);
-        } else {
-            offset += snprintf(buf + offset, sizeof(buf) - offset, "10%d", ansi_bg - 8);
+    // "\033[" + at most 5 parameters of up to 3 digits + separators + "m"
+    char buf[32];
+    buf[0] = '\033';
+    buf[1] = '[';
+    int len;
+
+    if (!pen_known) {
+        len = sgr_build_from_reset(buf, fg, bg, style);
+    } else {
+        char reset_buf[32];
+        reset_buf[0] = '\033';
+        reset_buf[1] = '[';
+        int reset_len = sgr_build_from_reset(reset_buf, fg, bg, style);
+        len = sgr_build_delta(buf, fg, bg, style);
+
+        // Resetting and re-adding can be shorter than turning attributes off
+        if (reset_len < len) {
+            memcpy(buf, reset_buf, reset_len);
+            len = reset_len;
         }
     }
 
-    buf[offset++] = 'm';
-    buf[offset] = '\0';
+    buf[len++] = 'm';
+    output_append(buf, len);
 
-    term_write(buf);
+    pen_fg = fg;
+    pen_bg = bg;
+    pen_style = style;
+    pen_known = true;
 }
 
-void term_set_style(style_t style) {
-    if (style == STYLE_NONE) {
-        return;
-    }
+void term_reset_style(void) {
+    term_set_pen(COLOR_DEFAULT, COLOR_DEFAULT, STYLE_NONE);
+}
 
-    if (style & STYLE_BOLD) {
-        term_write("\033[1m");
+void term_begin_sync_update(void) {
+    if (sync_update_supported) {
+        output_append_str(ANSI_SYNC_BEGIN);
     }
+}
 
-    if (style & STYLE_UNDERLINE) {
-        term_write("\033[4m");
+void term_end_sync_update(void) {
+    if (sync_update_supported) {
+        output_append_str(ANSI_SYNC_END);
     }
 }
 
-void term_reset_style(void) {
-    term_write("\033[0m");
+void term_set_sync_update_supported(bool supported) {
+    sync_update_supported = supported;
 }
 
 void term_enable_mouse(void) {
     // Enable mouse button tracking (SGR extended mode for better coordinates)
-    term_write("\033[?1000h");  // Enable mouse button events
-    term_write("\033[?1006h");  // Enable SGR extended coordinates
-    term_write("\033[?1003h");  // Enable mouse motion events
+    output_append_str("\033[?1000h");  // Enable mouse button events
+    output_append_str("\033[?1002h");  // Report motion while a button is held (drags)
+    output_append_str("\033[?1006h");  // Enable SGR extended coordinates
+    if (mouse_motion) {
+        output_append_str("\033[?1003h");  // Enable mouse motion events
+    }
+    mouse_enabled = true;
+}
+
+void term_set_mouse_motion(bool enabled) {
+    if (enabled == mouse_motion) {
+        return;
+    }
+    mouse_motion = enabled;
+
+    if (mouse_enabled) {
+        // The tracking modes replace each other, and turning one off stops
+        // tracking altogether, so drag reporting is switched back on
+        output_append_str(enabled ? "\033[?1003h" : "\033[?1003l\033[?1002h");
+    }
 }
 
 void term_disable_mouse(void) {
     // Disable all mouse tracking
-    term_write("\033[?1003l");  // Disable mouse motion events
-    term_write("\033[?1006l");  // Disable SGR extended coordinates
-    term_write("\033[?1000l");  // Disable mouse button events
+    output_append_str("\033[?1003l");  // Disable mouse motion events
+    output_append_str("\033[?1002l");  // Disable drag events
+    output_append_str("\033[?1006l");  // Disable SGR extended coordinates
+    output_append_str("\033[?1000l");  // Disable mouse button events
+    mouse_enabled = false;
 }
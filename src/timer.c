@@ -0,0 +1,256 @@
+#include "internal/timer.h"
+#include <stdlib.h>
+
+// Timer ids pack the pool index (plus one, so ids are never 0) with the
+// entry's generation, so an id goes stale once its timer is done
+#define TIMER_INDEX_BITS 20
+#define TIMER_INDEX_MASK ((1 << TIMER_INDEX_BITS) - 1)
+#define TIMER_GENERATION_MASK 0x7FF
+
+// List of timers taken out of their slots to fire
+#define TIMER_FIRING TIMER_WHEEL_SLOTS
+
+typedef struct {
+    uint64_t expires_tick;
+    uint64_t interval_ticks;  // 0 = fire once
+    void (*fn)(void* ctx);
+    void* ctx;
+    int list;                 // Slot (or TIMER_FIRING) the timer is linked into
+    int prev, next;           // Links within the list, or the free list (-1 = none)
+    unsigned int generation;  // Bumped whenever the entry is released
+    bool pending;
+} timer_entry_t;
+
+// Entries are linked by index, so the pool can grow with realloc()
+static timer_entry_t* timers = NULL;
+static int timer_capacity = 0;
+static int free_list = -1;
+
+static int heads[TIMER_WHEEL_SLOTS + 1];
+static bool heads_ready = false;
+static int pending_count = 0;
+static uint64_t last_tick = 0;  // Every slot up to this tick has been run
+
+static void init_heads(void) {
+    for (int i = 0; i <= TIMER_WHEEL_SLOTS; i++) {
+        heads[i] = -1;
+    }
+    heads_ready = true;
+}
+
+static void link_timer(int index, int list) {
+    timer_entry_t* timer = &timers[index];
+    timer->list = list;
+    timer->prev = -1;
+    timer->next = heads[list];
+    if (heads[list] != -1) {
+        timers[heads[list]].prev = index;
+    }
+    heads[list] = index;
+}
+
+static void unlink_timer(int index) {
+    timer_entry_t* timer = &timers[index];
+    if (timer->prev != -1) {
+        timers[timer->prev].next = timer->next;
+    } else {
+        heads[timer->list] = timer->next;
+    }
+    if (timer->next != -1) {
+        timers[timer->next].prev = timer->prev;
+    }
+}
+
+static void schedule(int index, uint64_t expires_tick) {
+    timers[index].expires_tick = expires_tick;
+    link_timer(index, (int)(expires_tick & (TIMER_WHEEL_SLOTS - 1)));
+}
+
+static void release(int index) {
+    timer_entry_t* timer = &timers[index];
+    timer->pending = false;
+    timer->generation++;
+    timer->next = free_list;
+    free_list = index;
+    pending_count--;
+}
+
+static int acquire(void) {
+    if (free_list == -1) {
+        if (timer_capacity > TIMER_INDEX_MASK / 2) {
+            return -1;
+        }
+
+        int new_capacity = timer_capacity == 0 ? 16 : timer_capacity * 2;
+        timer_entry_t* new_timers = realloc(timers, new_capacity * sizeof(timer_entry_t));
+        if (!new_timers) {
+            return -1;
+        }
+
+        for (int i = new_capacity - 1; i >= timer_capacity; i--) {
+            new_timers[i].generation = 0;
+            new_timers[i].pending = false;
+            new_timers[i].next = free_list;
+            free_list = i;
+        }
+        timers = new_timers;
+        timer_capacity = new_capacity;
+    }
+
+    int index = free_list;
+    free_list = timers[index].next;
+    pending_count++;
+    return index;
+}
+
+int timer_add(uint64_t now_us, int delay_ms, int interval_ms,
+              void (*fn)(void* ctx), void* ctx) {
+    if (!fn) {
+        return 0;
+    }
+    if (!heads_ready) {
+        init_heads();
+    }
+
+    uint64_t now_tick = now_us / TIMER_TICK_US;
+    if (pending_count == 0) {
+        // Nothing to catch up on
+        last_tick = now_tick;
+    }
+
+    int index = acquire();
+    if (index < 0) {
+        return 0;
+    }
+
+    timer_entry_t* timer = &timers[index];
+    timer->fn = fn;
+    timer->ctx = ctx;
+    timer->interval_ticks = interval_ms > 0 ? (uint64_t)interval_ms : 0;
+    timer->pending = true;
+
+    // Slots up to last_tick have already been run
+    uint64_t expires_tick = now_tick + (delay_ms > 0 ? (uint64_t)delay_ms : 0);
+    if (expires_tick <= last_tick) {
+        expires_tick = last_tick + 1;
+    }
+    schedule(index, expires_tick);
+
+    return (int)(((timer->generation & TIMER_GENERATION_MASK) << TIMER_INDEX_BITS) |
+                 (unsigned int)(index + 1));
+}
+
+bool timer_cancel(int id) {
+    if (id <= 0) {
+        return false;
+    }
+
+    int index = (id & TIMER_INDEX_MASK) - 1;
+    unsigned int generation = (unsigned int)id >> TIMER_INDEX_BITS;
+    if (index < 0 || index >= timer_capacity || !timers[index].pending ||
+        (timers[index].generation & TIMER_GENERATION_MASK) != generation) {
+        return false;
+    }
+
+    unlink_timer(index);
+    release(index);
+    return true;
+}
+
+bool timer_run_due(uint64_t now_us) {
+    uint64_t now_tick = now_us / TIMER_TICK_US;
+    if (pending_count == 0 || now_tick <= last_tick) {
+        if (now_tick > last_tick) {
+            last_tick = now_tick;
+        }
+        return false;
+    }
+
+    // After a long sleep every slot is visited once
+    uint64_t ticks = now_tick - last_tick;
+    if (ticks > TIMER_WHEEL_SLOTS) {
+        ticks = TIMER_WHEEL_SLOTS;
+    }
+
+    // Timers added by the callbacks below must expire after now_tick: the
+    // slots up to it may already have been swept
+    uint64_t first_tick = last_tick + 1;
+    last_tick = now_tick;
+
+    bool fired = false;
+    for (uint64_t tick = first_tick; tick < first_tick + ticks; tick++) {
+        int slot = (int)(tick & (TIMER_WHEEL_SLOTS - 1));
+
+        // Move the due timers aside first: callbacks may add or cancel
+        // timers, including ones in this slot
+        int index = heads[slot];
+        while (index != -1) {
+            int next = timers[index].next;
+            if (timers[index].expires_tick <= now_tick) {
+                unlink_timer(index);
+                link_timer(index, TIMER_FIRING);
+            }
+            index = next;
+        }
+
+        while (heads[TIMER_FIRING] != -1) {
+            index = heads[TIMER_FIRING];
+            timer_entry_t* timer = &timers[index];
+            void (*fn)(void* ctx) = timer->fn;
+            void* ctx = timer->ctx;
+
+            unlink_timer(index);
+            if (timer->interval_ticks > 0) {
+                // Skip missed intervals rather than firing them all at once
+                uint64_t expires_tick = timer->expires_tick + timer->interval_ticks;
+                if (expires_tick <= now_tick) {
+                    expires_tick = now_tick + timer->interval_ticks;
+                }
+                schedule(index, expires_tick);
+            } else {
+                release(index);
+            }
+
+            fn(ctx);
+            fired = true;
+        }
+    }
+
+    return fired;
+}
+
+bool timer_next_deadline(uint64_t* deadline_us) {
+    if (pending_count == 0) {
+        return false;
+    }
+
+    // Every pending timer expires after last_tick, so the first slot holding
+    // a timer due on its own tick holds the earliest one
+    uint64_t earliest = 0;
+    for (uint64_t tick = last_tick + 1; tick <= last_tick + TIMER_WHEEL_SLOTS; tick++) {
+        int index = heads[tick & (TIMER_WHEEL_SLOTS - 1)];
+        while (index != -1) {
+            uint64_t expires_tick = timers[index].expires_tick;
+            if (expires_tick == tick) {
+                *deadline_us = expires_tick * TIMER_TICK_US;
+                return true;
+            }
+            if (earliest == 0 || expires_tick < earliest) {
+                earliest = expires_tick;
+            }
+            index = timers[index].next;
+        }
+    }
+
+    *deadline_us = earliest * TIMER_TICK_US;
+    return true;
+}
+
+void timer_free_all(void) {
+    free(timers);
+    timers = NULL;
+    timer_capacity = 0;
+    free_list = -1;
+    pending_count = 0;
+    init_heads();
+}
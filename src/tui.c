@@ -1,5 +1,9 @@
+// clock_gettime() is POSIX, not standard C
+#define _POSIX_C_SOURCE 200809L
+
 #include "../include/intuitive.h"
 #include "internal/terminal.h"
+#include "internal/screen.h"
 #include "internal/component.h"
 #include "internal/layout.h"
 #include "internal/renderer.h"
@@ -7,29 +11,45 @@
 #include "internal/focus.h"
 #include "internal/tui.h"
 #include "internal/diff.h"
+#include "internal/arena.h"
+#include "internal/animation.h"
+#include "internal/memo.h"
+#include "internal/timer.h"
+#include "internal/hit_test.h"
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdatomic.h>
 #include <unistd.h>
 #include <string.h>
 #include <ctype.h>
+#include <time.h>
 
 /**
  * TUI state
  */
 typedef struct {
     component_t* (*root_fn)(void);
-    component_t* root;
-    component_t* prev_root;  // Previous tree for diffing
+    component_t* root;       // Tree of the last frame, kept for diffing and events
+    arena_t frame_arenas[2]; // Alternating per-frame arenas for the component trees
+    int frame_parity;        // Index of the arena the next frame is built in
+    animation_manager_t animations;  // Owns scroll animations started by the renderer
     bool running;
     int term_width;
     int term_height;
     bool show_cursor;
     int cursor_x;
     int cursor_y;
+    bool has_frame_stats;
+    tui_frame_stats_t frame_stats;  // Cost of the last rendered frame
+    atomic_bool render_requested;    // Render the next frame even if the diff finds no changes
+    uint64_t frame_deadline_us;      // Render again by this time (0 = not scheduled)
 } tui_state_t;
 
 static tui_state_t tui_state = {0};
 
+// Events handled before rendering, so a flood of input can't stall the screen
+#define MAX_EVENTS_PER_FRAME 1024
+
 void tui_init(void) {
     // Initialize terminal
     if (!term_init()) {
@@ -38,6 +58,19 @@ void tui_init(void) {
 
     // Get terminal size
     term_get_size(&tui_state.term_width, &tui_state.term_height);
+
+    // Allocate the frame buffers the renderer draws into
+    if (!screen_init(tui_state.term_width, tui_state.term_height)) {
+        term_cleanup();
+        exit(1);
+    }
+
+    // Wakeups for tui_request_render() and resizes while the loop sleeps
+    if (!event_init()) {
+        screen_free();
+        term_cleanup();
+        exit(1);
+    }
 }
 
 void tui_set_root(component_t* (*root_fn)(void)) {
@@ -45,8 +78,79 @@ void tui_set_root(component_t* (*root_fn)(void)) {
 }
 
 void tui_request_render(void) {
-    // No-op: The event loop now continuously renders to support animations
-    // The diff system prevents unnecessary screen updates
+    // The diff can't see everything: state can change outside the event
+    // loop, and reused memo subtrees aren't diffed at all
+    atomic_store(&tui_state.render_requested, true);
+    event_wake();
+}
+
+void tui_set_mouse_motion(bool enabled) {
+    term_set_mouse_motion(enabled);
+}
+
+bool tui_post(void (*fn)(void* ctx), void* ctx) {
+    return event_post(fn, ctx);
+}
+
+void tui_schedule_frame(uint64_t time_us) {
+    if (tui_state.frame_deadline_us == 0 || time_us < tui_state.frame_deadline_us) {
+        tui_state.frame_deadline_us = time_us;
+    }
+}
+
+int tui_set_timeout(int delay_ms, void (*fn)(void* ctx), void* ctx) {
+    return timer_add(anim_get_time_us(), delay_ms, 0, fn, ctx);
+}
+
+int tui_set_interval(int interval_ms, void (*fn)(void* ctx), void* ctx) {
+    if (interval_ms <= 0) {
+        return 0;
+    }
+    return timer_add(anim_get_time_us(), interval_ms, interval_ms, fn, ctx);
+}
+
+bool tui_cancel_timer(int timer_id) {
+    return timer_cancel(timer_id);
+}
+
+/**
+ * Monotonic time in nanoseconds for the frame statistics
+ * Real time, even when the backend's clock is virtual
+ */
+static uint64_t profile_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static bool frame_due(void) {
+    return tui_state.frame_deadline_us != 0 && anim_get_time_us() >= tui_state.frame_deadline_us;
+}
+
+/**
+ * Milliseconds until the scheduled frame or the next timer is due, rounded
+ * up so the loop doesn't wake just short of it; -1 if nothing is scheduled
+ */
+static int wait_timeout_ms(void) {
+    uint64_t deadline = tui_state.frame_deadline_us;
+    uint64_t timer_deadline;
+    if (timer_next_deadline(&timer_deadline) && (deadline == 0 || timer_deadline < deadline)) {
+        deadline = timer_deadline;
+    }
+    if (deadline == 0) {
+        return -1;
+    }
+
+    uint64_t now = anim_get_time_us();
+    if (now >= deadline) {
+        return 0;
+    }
+
+    uint64_t remaining_us = deadline - now;
+    if (remaining_us > 60000000) {
+        remaining_us = 60000000;
+    }
+    return (int)((remaining_us + 999) / 1000);
 }
 
 bool tui_get_terminal_size(int* width, int* height) {
@@ -63,32 +167,62 @@ bool tui_get_terminal_size(int* width, int* height) {
     return false;
 }
 
+bool tui_get_frame_stats(tui_frame_stats_t* stats) {
+    if (!stats || !tui_state.has_frame_stats) {
+        return false;
+    }
+    *stats = tui_state.frame_stats;
+    return true;
+}
+
+void tui_add_animation(animation_t* anim) {
+    anim_manager_add(&tui_state.animations, anim);
+}
+
 void tui_set_cursor(int x, int y) {
     tui_state.show_cursor = true;
     tui_state.cursor_x = x;
     tui_state.cursor_y = y;
 }
 
-static struct component_t* find_open_modal(struct component_t* component) {
-    if (!component) {
-        return NULL;
+/**
+ * Insert pasted text into the focused Input in one go
+ * Only printable characters are kept, as when typing
+ */
+static bool handle_paste(struct component_t* focused, const char* text, size_t length) {
+    if (!focused || focused->type != COMPONENT_INPUT) {
+        return false;
     }
 
-    if (component->type == COMPONENT_MODAL) {
-        modal_data_t* data = (modal_data_t*)component->data;
-        if (data && data->is_open && *data->is_open) {
-            return component;
-        }
+    input_data_t* data = (input_data_t*)focused->data;
+    size_t len = strlen(data->buffer);
+    if (len + 1 >= data->buffer_size) {
+        return false;
     }
+    size_t space = data->buffer_size - 1 - len;
 
-    for (int i = 0; i < component->child_count; i++) {
-        struct component_t* modal = find_open_modal(component->children[i]);
-        if (modal) {
-            return modal;
+    size_t count = 0;
+    for (size_t i = 0; i < length && count < space; i++) {
+        if (isprint((unsigned char)text[i])) {
+            count++;
         }
     }
+    if (count == 0) {
+        return false;
+    }
 
-    return NULL;
+    // Open a gap at the cursor once, then fill it
+    memmove(&data->buffer[data->cursor_pos + count],
+            &data->buffer[data->cursor_pos],
+            len - data->cursor_pos + 1);
+    char* out = &data->buffer[data->cursor_pos];
+    for (size_t i = 0; i < length && out < &data->buffer[data->cursor_pos + count]; i++) {
+        if (isprint((unsigned char)text[i])) {
+            *out++ = text[i];
+        }
+    }
+    data->cursor_pos += count;
+    return true;
 }
 
 static bool handle_input_event(struct component_t* focused, event_t* event) {
@@ -198,34 +332,47 @@ static bool handle_input_event(struct component_t* focused, event_t* event) {
                 return true;
             }
         }
-    }
+    } else if (focused->type == COMPONENT_TABLE) {
+        table_data_t* data = (table_data_t*)focused->data;
+        if (!data || !data->selected_row) {
+            return false;
+        }
 
-    return false;
-}
+        int key = event->data.key.code;
+        int selected = *data->selected_row;
 
-/**
- * Find component at given coordinates (recursive)
- */
-static struct component_t* find_component_at(struct component_t* component, int x, int y) {
-    if (!component) {
-        return NULL;
-    }
+        if (key == KEY_UP) {
+            if (selected > 0) {
+                (*data->selected_row)--;
 
-    // Check children first (depth-first, so top-most components checked first)
-    for (int i = component->child_count - 1; i >= 0; i--) {
-        struct component_t* found = find_component_at(component->children[i], x, y);
-        if (found) {
-            return found;
-        }
-    }
+                // Auto-scroll if selection moves off screen
+                if (data->scroll_offset && *data->selected_row < *data->scroll_offset) {
+                    *data->scroll_offset = *data->selected_row;
+                }
+                return true;
+            }
+        } else if (key == KEY_DOWN) {
+            if (selected < data->row_count - 1) {
+                (*data->selected_row)++;
 
-    // Check if this component contains the point
-    if (x >= component->x && x < component->x + component->width &&
-        y >= component->y && y < component->y + component->height) {
-        return component;
+                // Auto-scroll if selection moves off screen
+                if (data->scroll_offset) {
+                    int visible_end = *data->scroll_offset + data->max_visible_rows;
+                    if (*data->selected_row >= visible_end) {
+                        *data->scroll_offset = *data->selected_row - data->max_visible_rows + 1;
+                    }
+                }
+                return true;
+            }
+        } else if (key == KEY_ENTER || key == '\r') {
+            if (data->on_select) {
+                data->on_select(*data->selected_row);
+                return true;
+            }
+        }
     }
 
-    return NULL;
+    return false;
 }
 
 /**
@@ -268,6 +415,29 @@ static bool handle_mouse_click(struct component_t* component, int x, int y) {
             break;
         }
 
+        case COMPONENT_TABLE: {
+            table_data_t* data = (table_data_t*)component->data;
+            if (data && data->selected_row) {
+                // Rows start below the header, separator and top border
+                int header_lines = data->show_borders ? 3 : 2;
+                int relative_y = y - component->y - header_lines;
+                int scroll_offset = data->scroll_offset ? *data->scroll_offset : 0;
+                int clicked_row = scroll_offset + relative_y;
+
+                if (relative_y >= 0 && clicked_row < data->row_count) {
+                    *data->selected_row = clicked_row;
+
+                    // Call on_select if present
+                    if (data->on_select) {
+                        data->on_select(clicked_row);
+                    }
+
+                    return true;
+                }
+            }
+            break;
+        }
+
         default:
             break;
     }
@@ -283,7 +453,7 @@ static bool handle_mouse_scroll(struct component_t* component, int delta) {
         return false;
     }
 
-    // Find scrollable component (List or ScrollView)
+    // Find scrollable component (List, Table or ScrollView)
     if (component->type == COMPONENT_LIST) {
         list_data_t* data = (list_data_t*)component->data;
         if (data && data->scroll_offset) {
@@ -294,6 +464,21 @@ static bool handle_mouse_scroll(struct component_t* component, int delta) {
             if (max_offset < 0) max_offset = 0;
             if (new_offset > max_offset) new_offset = max_offset;
 
+            if (new_offset != *data->scroll_offset) {
+                *data->scroll_offset = new_offset;
+                return true;
+            }
+        }
+    } else if (component->type == COMPONENT_TABLE) {
+        table_data_t* data = (table_data_t*)component->data;
+        if (data && data->scroll_offset) {
+            int new_offset = *data->scroll_offset + delta;  // Positive delta = scroll down
+            if (new_offset < 0) new_offset = 0;
+
+            int max_offset = data->row_count - data->max_visible_rows;
+            if (max_offset < 0) max_offset = 0;
+            if (new_offset > max_offset) new_offset = max_offset;
+
             if (new_offset != *data->scroll_offset) {
                 *data->scroll_offset = new_offset;
                 return true;
@@ -319,117 +504,275 @@ static bool handle_mouse_scroll(struct component_t* component, int delta) {
     return false;
 }
 
+/**
+ * Handle one event against the tree of the last frame
+ * Returns false if the event can't have changed anything on screen
+ */
+static bool dispatch_event(event_t* event) {
+    if (event->type == EVENT_KEY) {
+        int key = event->data.key.code;
+
+        // Check if a modal is open
+        struct component_t* open_modal = hit_test_open_modal();
+
+        // Check for Esc to close modal (works always)
+        if (key == KEY_ESC && open_modal) {
+            modal_data_t* data = (modal_data_t*)open_modal->data;
+            if (data && data->on_close) {
+                data->on_close();
+            }
+        } else if (key == KEY_TAB) {
+            focus_next();
+        } else {
+            struct component_t* focused = focus_get_current();
+            bool handled = handle_input_event(focused, event);
+            if (!handled) {
+                // Key not consumed by component
+
+                // If modal is open with no focusable elements, any key closes it
+                if (open_modal && !focused) {
+                    modal_data_t* data = (modal_data_t*)open_modal->data;
+                    if (data && data->on_close) {
+                        data->on_close();
+                    }
+                } else if (key == 'q' || key == 'Q') {
+                    // Only allow quit if no modal is open
+                    if (!open_modal) {
+                        tui_state.running = false;
+                    }
+                }
+            }
+        }
+    } else if (event->type == EVENT_PASTE) {
+        bool inserted = handle_paste(focus_get_current(), event->data.paste.text,
+                                     event->data.paste.length);
+        free(event->data.paste.text);
+        return inserted;
+    } else if (event->type == EVENT_POST) {
+        // Posted from another thread; the frame after it shows the result
+        event->data.post.fn(event->data.post.ctx);
+    } else if (event->type == EVENT_QUIT) {
+        tui_state.running = false;
+        return false;
+    } else if (event->type == EVENT_MOUSE) {
+        // Handle mouse events
+        int mouse_x = event->data.mouse.x;
+        int mouse_y = event->data.mouse.y;
+        mouse_button_t button = event->data.mouse.button;
+        mouse_action_t action = event->data.mouse.action;
+
+        // Find component under mouse
+        struct component_t* target = hit_test_at(mouse_x, mouse_y);
+        bool changed = false;
+
+        // Focus follows mouse - if the component is focusable, focus it
+        if (target && target->focusable && !target->focused) {
+            changed = focus_set(target);
+        }
+
+        // Handle left click
+        if (button == MOUSE_LEFT && action == MOUSE_PRESS && target) {
+            // Click callbacks can change anything
+            handle_mouse_click(target, mouse_x, mouse_y);
+            changed = true;
+        }
+        // Handle scroll wheel; consecutive steps arrive summed
+        else if ((button == MOUSE_SCROLL_UP || button == MOUSE_SCROLL_DOWN) && action == MOUSE_PRESS && target) {
+            if (handle_mouse_scroll(target, event->data.mouse.scroll_delta)) {
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    return true;
+}
+
+/**
+ * Redraw a whole subtree in the next frame
+ */
+static void damage_subtree(struct component_t* tree) {
+    screen_damage(tree->paint_x, tree->paint_y, tree->paint_width, tree->paint_height);
+}
+
 void tui_run(void) {
     if (!tui_state.root_fn) {
         return;
     }
 
     tui_state.running = true;
+    anim_manager_init(&tui_state.animations);
+    arena_init(&tui_state.frame_arenas[0], 0);
+    arena_init(&tui_state.frame_arenas[1], 0);
 
     while (tui_state.running) {
+        // Take the request before anything reads state: one made from
+        // another thread while this frame is built stays set for the next
+        bool render_requested = atomic_exchange(&tui_state.render_requested, false);
+
+        // Timer callbacks update state the new frame should show
+        if (timer_run_due(anim_get_time_us())) {
+            render_requested = true;
+        }
+
+        // Pick up terminal resizes before the frame is laid out; resizing
+        // forces a full repaint. The screen buffer holds the size the last
+        // frame was drawn at, which tui_get_terminal_size() doesn't touch.
+        bool resized = false;
+        int width, height, screen_width, screen_height;
+        screen_get_size(&screen_width, &screen_height);
+        if (term_get_size(&width, &height) && (width != screen_width || height != screen_height)) {
+            tui_state.term_width = width;
+            tui_state.term_height = height;
+            screen_resize(width, height);
+            resized = true;
+        }
+
+        // Build the new tree in the arena that held the frame before last;
+        // the previous frame's tree lives in the other one until it is diffed
+        uint64_t frame_start_ns = profile_now_ns();
+        arena_t* frame_arena = &tui_state.frame_arenas[tui_state.frame_parity];
+        arena_reset(frame_arena);
+
+        memo_begin_frame();
+        component_use_arena(frame_arena);
         component_t* new_root = tui_state.root_fn();
+        component_use_arena(NULL);
         if (!new_root) {
             break;
         }
 
+        uint64_t built_ns = profile_now_ns();
+
         // Measure and layout new tree
         layout_measure(new_root);
-        layout_position(new_root, 0, 0);
+        uint64_t measured_ns = profile_now_ns();
+        layout_position(new_root, 0, 0, resized);
+        uint64_t positioned_ns = profile_now_ns();
+
+        // Move focus onto the new tree before diffing, since focus is part
+        // of each component's hash
+        bool focus_moved = focus_build_list(new_root);
+        uint64_t focused_ns = profile_now_ns();
+
+        // Diff with previous tree; what changed is damaged for the next render
+        bool has_changes = component_diff_trees(tui_state.root, new_root);
+        if (focus_moved || render_requested) {
+            // Focus and state inside a reused memo subtree aren't seen by
+            // the diff, so those subtrees are redrawn whole
+            memo_visit_reused(damage_subtree);
+            has_changes = true;
+        }
+        if (frame_due()) {
+            // Animations damaged what they draw when they scheduled it
+            has_changes = true;
+        }
+        if (resized) {
+            has_changes = true;
+        }
 
-        // Diff with previous tree
-        bool has_changes = component_diff_trees(tui_state.prev_root, new_root);
+        // Memo subtrees the previous tree still pointed at can go now
+        memo_end_frame();
+        uint64_t diffed_ns = profile_now_ns();
 
         // Only render if there are actual changes
-        if (has_changes || !tui_state.prev_root) {
-            focus_build_list(new_root);
-            term_clear();
-            term_hide_cursor();
+        if (has_changes || !tui_state.root) {
+            uint64_t render_start_ns = profile_now_ns();
+            term_reset_output_stats();
 
+            // Animations on screen schedule their next frame as they draw
+            tui_state.frame_deadline_us = 0;
+
+            // The focused Input places the cursor as it draws
+            struct component_t* focused = focus_get_current();
+            if (focused && focused->type == COMPONENT_INPUT) {
+                damage_subtree(focused);
+            }
+
+            // Redraw the damaged parts off-screen, then send only the
+            // cells that changed
+            screen_begin_frame();
             tui_state.show_cursor = false;
             render_component(new_root);
 
+            // Bracket the frame so the terminal presents it atomically
+            term_begin_sync_update();
+            term_hide_cursor();
+            screen_present();
+
             if (tui_state.show_cursor) {
                 term_move_cursor(tui_state.cursor_x, tui_state.cursor_y);
                 term_show_cursor();
             }
+            term_end_sync_update();
+            uint64_t rendered_ns = profile_now_ns();
+
+            // Send the whole frame in one go
+            term_flush();
+            uint64_t flushed_ns = profile_now_ns();
+
+            term_output_stats_t output;
+            term_get_output_stats(&output);
+            tui_frame_stats_t* stats = &tui_state.frame_stats;
+            stats->syscalls = output.syscalls;
+            stats->bytes = output.bytes;
+            stats->frame++;
+            stats->build_ns = built_ns - frame_start_ns;
+            stats->measure_ns = measured_ns - built_ns;
+            stats->position_ns = positioned_ns - measured_ns;
+            stats->focus_ns = focused_ns - positioned_ns;
+            stats->diff_ns = diffed_ns - focused_ns;
+            stats->render_ns = rendered_ns - render_start_ns;
+            stats->flush_ns = flushed_ns - rendered_ns;
+            tui_state.has_frame_stats = true;
         }
 
-        // Free the oldest tree (prev_root from 2 frames ago)
-        if (tui_state.prev_root) {
-            component_free(tui_state.prev_root);
-        }
+        // Finished and cancelled animations are no longer referenced
+        anim_manager_cleanup(&tui_state.animations);
 
-        tui_state.prev_root = tui_state.root;
+        // The previous tree is released when its arena is reused next frame
         tui_state.root = new_root;
+        tui_state.frame_parity ^= 1;
+        hit_test_set_tree(new_root, tui_state.term_width, tui_state.term_height);
+
+        // Sleep until something needs a new frame: input that changed
+        // something, a render request, or a scheduled frame or timer.
+        // Wakeups with nothing to do go straight back to sleep.
+        while (tui_state.running && !atomic_load(&tui_state.render_requested)) {
+            int timeout_ms = wait_timeout_ms();
+            if (timeout_ms == 0) {
+                break;
+            }
 
-        event_t event;
-        if (event_poll(&event)) {
-            if (event.type == EVENT_KEY) {
-                int key = event.data.key.code;
-
-                // Check if a modal is open
-                struct component_t* open_modal = find_open_modal(tui_state.root);
-
-                // Check for Esc to close modal (works always)
-                if (key == KEY_ESC && open_modal) {
-                    modal_data_t* data = (modal_data_t*)open_modal->data;
-                    if (data && data->on_close) {
-                        data->on_close();
-                    }
-                } else if (key == KEY_TAB) {
-                    focus_next();
-                } else {
-                    struct component_t* focused = focus_get_current();
-                    bool handled = handle_input_event(focused, &event);
-                    if (!handled) {
-                        // Key not consumed by component
-
-                        // If modal is open with no focusable elements, any key closes it
-                        if (open_modal && !focused) {
-                            modal_data_t* data = (modal_data_t*)open_modal->data;
-                            if (data && data->on_close) {
-                                data->on_close();
-                            }
-                        } else if (key == 'q' || key == 'Q') {
-                            // Only allow quit if no modal is open
-                            if (!open_modal) {
-                                tui_state.running = false;
-                            }
-                        }
-                    }
-                }
-            } else if (event.type == EVENT_MOUSE) {
-                // Handle mouse events
-                int mouse_x = event.data.mouse.x;
-                int mouse_y = event.data.mouse.y;
-                mouse_button_t button = event.data.mouse.button;
-                mouse_action_t action = event.data.mouse.action;
-
-                // Find component under mouse
-                struct component_t* target = find_component_at(tui_state.root, mouse_x, mouse_y);
-
-                // Focus follows mouse - if the component is focusable, focus it
-                if (target && target->focusable && !target->focused) {
-                    focus_set(target);
-                }
+            event_t event;
+            if (!event_poll(&event, timeout_ms)) {
+                continue;
+            }
 
-                // Handle left click
-                if (button == MOUSE_LEFT && action == MOUSE_PRESS && target) {
-                    handle_mouse_click(target, mouse_x, mouse_y);
-                }
-                // Handle scroll wheel
-                else if ((button == MOUSE_SCROLL_UP || button == MOUSE_SCROLL_DOWN) && action == MOUSE_PRESS && target) {
-                    handle_mouse_scroll(target, button == MOUSE_SCROLL_UP ? -1 : 1);
+            // Handle the whole burst, then render it once. Input handlers
+            // change state through pointers the diff can't see inside
+            // reused memo subtrees, so any effect asks for a render.
+            int handled = 0;
+            do {
+                if (dispatch_event(&event)) {
+                    atomic_store(&tui_state.render_requested, true);
                 }
-            }
+            } while (tui_state.running && ++handled < MAX_EVENTS_PER_FRAME &&
+                     event_poll(&event, 0));
         }
     }
 
-    if (tui_state.root) {
-        component_free(tui_state.root);
-    }
-    if (tui_state.prev_root) {
-        component_free(tui_state.prev_root);
-    }
+    tui_state.root = NULL;
+    hit_test_free();
+    focus_clear();
+    arena_free(&tui_state.frame_arenas[0]);
+    arena_free(&tui_state.frame_arenas[1]);
+    // Cached subtrees cancel their animations, so free them first
+    memo_free_all();
+    anim_manager_free_all(&tui_state.animations);
+    timer_free_all();
+    toast_reset();  // Their timer ids died with the timers
+    event_cleanup();
+    screen_free();
     term_cleanup();
 }
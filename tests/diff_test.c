@@ -0,0 +1,132 @@
+/**
+ * Keyed diff: children matched by key, moves found through the longest
+ * increasing subsequence
+ *
+ * Trees are diffed directly, without layout, so children differ only in
+ * content and order. Only inserted children and those that moved against
+ * the longest run kept in order may come out dirty.
+ */
+
+#include "intuitive.h"
+#include "internal/component.h"
+#include "internal/diff.h"
+#include "internal/screen.h"
+#include <stdio.h>
+#include <string.h>
+
+#define MAX_CHILDREN 8
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+    if (!ok) {
+        fprintf(stderr, "diff_test: %s\n", what);
+        failures++;
+    }
+}
+
+/**
+ * A VStack of keyed Texts, one per character of keys, showing their key
+ */
+static component_t* keyed_stack(const char* keys) {
+    static char labels[MAX_CHILDREN][2];
+    component_t* children[MAX_CHILDREN + 1];
+    int count = (int)strlen(keys);
+    for (int i = 0; i < count; i++) {
+        labels[i][0] = keys[i];
+        labels[i][1] = '\0';
+        children[i] = Keyed(labels[i], Text(labels[i], TEXT_DEFAULT));
+    }
+    children[count] = NULL;
+    return VStackArray(children);
+}
+
+/**
+ * Diff old_keys against new_keys and check which new children are dirty
+ * dirty_keys lists the keys expected dirty, in any order
+ */
+static void check_diff(const char* old_keys, const char* new_keys, const char* dirty_keys) {
+    component_t* old_tree = keyed_stack(old_keys);
+    component_t* new_tree = keyed_stack(new_keys);
+    if (!old_tree || !new_tree) {
+        expect(false, "out of memory");
+        component_free(old_tree);
+        component_free(new_tree);
+        return;
+    }
+
+    // The old tree was the new one once, which hashed it
+    component_diff_trees(NULL, old_tree);
+    bool changed = component_diff_trees(old_tree, new_tree);
+
+    bool dirty_ok = true;
+    for (int i = 0; i < new_tree->child_count; i++) {
+        bool expected = strchr(dirty_keys, new_keys[i]) != NULL;
+        if (new_tree->children[i]->dirty != expected) {
+            dirty_ok = false;
+        }
+    }
+
+    if (changed != (strcmp(old_keys, new_keys) != 0) || !dirty_ok) {
+        fprintf(stderr, "diff_test: %s -> %s doesn't redraw exactly \"%s\"\n",
+                old_keys, new_keys, dirty_keys);
+        failures++;
+    }
+
+    component_free(old_tree);
+    component_free(new_tree);
+}
+
+static void test_moves(void) {
+    check_diff("abcd", "abcd", "");
+    check_diff("abcd", "xabcd", "x");     // Insertion in front
+    check_diff("abcd", "abxcd", "x");
+    check_diff("abcd", "acd", "");        // Removal
+    check_diff("abcde", "bcdea", "a");    // First to last
+    check_diff("abcde", "eabcd", "e");    // Last to first
+    check_diff("abcdef", "afcdeb", "fb"); // Swap around a run
+    check_diff("abcd", "dcba", "dcb");    // Only one can stay
+    check_diff("abcde", "bxdca", "xda");  // Ties keep the run ending last
+}
+
+static void test_state_follows_key(void) {
+    // A Spinner carries its animation frame to wherever its key goes
+    component_t* old_tree = VStack(Keyed("first", Spinner((SpinnerConfig){ .text = "1" })),
+                                   Keyed("second", Spinner((SpinnerConfig){ .text = "2" })),
+                                   NULL);
+    component_t* new_tree = VStack(Keyed("second", Spinner((SpinnerConfig){ .text = "2" })),
+                                   Keyed("first", Spinner((SpinnerConfig){ .text = "1" })),
+                                   NULL);
+    if (!old_tree || !new_tree) {
+        expect(false, "out of memory");
+        component_free(old_tree);
+        component_free(new_tree);
+        return;
+    }
+
+    ((spinner_data_t*)old_tree->children[0]->data)->frame_index = 3;
+    ((spinner_data_t*)old_tree->children[1]->data)->frame_index = 5;
+    component_diff_trees(NULL, old_tree);
+    component_diff_trees(old_tree, new_tree);
+
+    expect(((spinner_data_t*)new_tree->children[0]->data)->frame_index == 5 &&
+           ((spinner_data_t*)new_tree->children[1]->data)->frame_index == 3,
+           "reordered spinners don't keep their frames");
+
+    component_free(old_tree);
+    component_free(new_tree);
+}
+
+int main(void) {
+    // Diffing damages the screen
+    if (!screen_init(20, 10)) {
+        fprintf(stderr, "diff_test: can't allocate the screen\n");
+        return 1;
+    }
+
+    test_moves();
+    test_state_follows_key();
+
+    screen_free();
+    return failures == 0 ? 0 : 1;
+}
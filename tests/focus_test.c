@@ -0,0 +1,91 @@
+/**
+ * Focus identity: focus stays on the same component when focusables are
+ * inserted before it
+ *
+ * The app has two Inputs with the second focused. A timeout then inserts
+ * a focusable in front of them, and the text typed after that must still
+ * go to the second Input.
+ */
+
+#include "intuitive.h"
+#include <stdio.h>
+#include <string.h>
+
+static int failures = 0;
+
+// State of the app
+static bool keyed = false;
+static bool inserted = false;
+static char first[16];
+static char second[16];
+static char extra[16];
+
+static void expect(bool ok, const char* what) {
+    if (!ok) {
+        fprintf(stderr, "focus_test: %s\n", what);
+        failures++;
+    }
+}
+
+static void nothing(void) {
+}
+
+static component_t* app(void) {
+    component_t* front = NULL;
+    if (inserted) {
+        // Keyed apps insert an Input; unkeyed ones a Button, which doesn't
+        // shift the positions of the Inputs among themselves
+        front = keyed ? Keyed("extra", Input((InputConfig){ .buffer = extra, .size = sizeof(extra) }))
+                      : Button("extra", nothing);
+    }
+
+    component_t* first_input = Input((InputConfig){ .buffer = first, .size = sizeof(first) });
+    component_t* second_input = Input((InputConfig){ .buffer = second, .size = sizeof(second) });
+    if (keyed) {
+        first_input = Keyed("first", first_input);
+        second_input = Keyed("second", second_input);
+    }
+
+    return front ? VStack(front, first_input, second_input, NULL)
+                 : VStack(first_input, second_input, NULL);
+}
+
+static void insert(void* ctx) {
+    (void)ctx;
+    inserted = true;
+}
+
+static void run(bool use_keys) {
+    keyed = use_keys;
+    inserted = false;
+    memset(first, 0, sizeof(first));
+    memset(second, 0, sizeof(second));
+    memset(extra, 0, sizeof(extra));
+
+    // Focus the second Input and type into it, before and after the insertion
+    tui_headless_input(10, "\t", 1);
+    tui_headless_input(10, "a", 1);
+    tui_headless_input(100, "b", 1);
+
+    tui_init();
+    tui_set_root(app);
+    tui_set_timeout(50, insert, NULL);
+    tui_run();
+}
+
+int main(void) {
+    if (!tui_use_headless(20, 4)) {
+        fprintf(stderr, "focus_test: can't create the headless terminal\n");
+        return 1;
+    }
+
+    run(true);
+    expect(inserted && strcmp(second, "ab") == 0 && first[0] == '\0' && extra[0] == '\0',
+           "focus doesn't stay on a keyed Input when one is inserted before it");
+
+    run(false);
+    expect(inserted && strcmp(second, "ab") == 0 && first[0] == '\0',
+           "focus doesn't stay on an unkeyed Input when a Button is inserted before it");
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,146 @@
+/**
+ * Input parser: sequences split across reads, the Esc timeout and
+ * bracketed paste
+ *
+ * Input is scripted on the headless terminal and read back with
+ * event_poll(), as the event loop does, until the script runs out.
+ */
+
+#include "intuitive.h"
+#include "internal/events.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Longest paste kept, as in events.c
+#define PASTE_MAX_LENGTH (1024 * 1024)
+
+#define MAX_EVENTS 16
+
+static event_t events[MAX_EVENTS];
+static int event_count = 0;
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+    if (!ok) {
+        fprintf(stderr, "input_test: %s\n", what);
+        failures++;
+    }
+}
+
+static void free_events(void) {
+    for (int i = 0; i < event_count; i++) {
+        if (events[i].type == EVENT_PASTE) {
+            free(events[i].data.paste.text);
+        }
+    }
+    event_count = 0;
+}
+
+/**
+ * Collect the events of the scripted input, up to the end of it
+ */
+static void read_events(void) {
+    free_events();
+    for (;;) {
+        event_t event;
+        if (!event_poll(&event, -1)) {
+            continue;
+        }
+        if (event.type == EVENT_QUIT) {
+            return;
+        }
+        if (event_count < MAX_EVENTS) {
+            events[event_count++] = event;
+        } else if (event.type == EVENT_PASTE) {
+            free(event.data.paste.text);
+        }
+    }
+}
+
+static bool is_key(int index, int code) {
+    return index < event_count && events[index].type == EVENT_KEY &&
+           events[index].data.key.code == code;
+}
+
+static bool is_paste(int index, const char* text, size_t length) {
+    return index < event_count && events[index].type == EVENT_PASTE &&
+           events[index].data.paste.length == length &&
+           memcmp(events[index].data.paste.text, text, length) == 0;
+}
+
+static void test_split_sequence(void) {
+    // The rest of the sequence arrives within the Esc timeout
+    tui_headless_input(0, "\033[", 2);
+    tui_headless_input(5, "1;5A", 4);
+    tui_headless_input(5, "\033", 1);
+    tui_headless_input(5, "OB", 2);
+    read_events();
+    expect(event_count == 2 && is_key(0, KEY_UP) && is_key(1, KEY_DOWN),
+           "split CSI and SS3 arrows aren't read as Up, Down");
+}
+
+static void test_esc_timeout(void) {
+    // A lone ESC becomes the Esc key once nothing follows for a while;
+    // what comes after that is typed text, not part of a sequence
+    tui_headless_input(0, "\033", 1);
+    tui_headless_input(100, "[A", 2);
+    read_events();
+    expect(event_count == 3 && is_key(0, KEY_ESC) && is_key(1, '[') && is_key(2, 'A'),
+           "late bytes after ESC aren't read as Esc, '[', 'A'");
+
+    // An unfinished CSI is dropped when it times out
+    tui_headless_input(0, "\033[1;", 4);
+    tui_headless_input(100, "x", 1);
+    read_events();
+    expect(event_count == 1 && is_key(0, 'x'), "a timed out CSI isn't dropped");
+}
+
+static void test_paste(void) {
+    // Pastes may take their time, and end markers split across reads
+    // still end them
+    const char text[] = "hello \033[201x world";
+    tui_headless_input(0, "\033[200~hello \033[20", 16);
+    tui_headless_input(100, "1x wor", 6);
+    tui_headless_input(100, "ld\033[2", 5);
+    tui_headless_input(100, "01~k", 4);
+    read_events();
+    expect(event_count == 2 && is_paste(0, text, sizeof(text) - 1) && is_key(1, 'k'),
+           "a paste arriving in pieces isn't one paste followed by 'k'");
+}
+
+static void test_paste_limit(void) {
+    // Text past the limit is dropped, but the paste still ends at its
+    // marker and input after it is read as usual
+    size_t length = PASTE_MAX_LENGTH + 4096;
+    char* text = malloc(length);
+    if (!text) {
+        expect(false, "out of memory");
+        return;
+    }
+    memset(text, 'p', length);
+
+    tui_headless_input(0, "\033[200~", 6);
+    tui_headless_input(0, text, length);
+    tui_headless_input(0, "\033[201~z", 7);
+    read_events();
+    expect(event_count == 2 && is_paste(0, text, PASTE_MAX_LENGTH) && is_key(1, 'z'),
+           "an oversized paste isn't cut at the limit and followed by 'z'");
+    free(text);
+}
+
+int main(void) {
+    if (!tui_use_headless(20, 3) || !event_init()) {
+        fprintf(stderr, "input_test: can't set up the headless terminal\n");
+        return 1;
+    }
+
+    test_split_sequence();
+    test_esc_timeout();
+    test_paste();
+    test_paste_limit();
+
+    free_events();
+    event_cleanup();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,166 @@
+/**
+ * Mouse reports: coalescing of motion and wheel bursts
+ *
+ * Reports that arrive together fold into one event where only the sum
+ * matters; reports that arrive apart, or are separated by a press, don't.
+ * The last check scrolls a List with the wheel through tui_run().
+ */
+
+#include "intuitive.h"
+#include "internal/events.h"
+#include <stdio.h>
+#include <string.h>
+
+#define MAX_EVENTS 16
+
+#define LIST_ITEMS 20
+
+static event_t events[MAX_EVENTS];
+static int event_count = 0;
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+    if (!ok) {
+        fprintf(stderr, "mouse_test: %s\n", what);
+        failures++;
+    }
+}
+
+static void type(int delay_ms, const char* bytes) {
+    tui_headless_input(delay_ms, bytes, strlen(bytes));
+}
+
+/**
+ * Collect the events of the scripted input, up to the end of it
+ */
+static void read_events(void) {
+    event_count = 0;
+    for (;;) {
+        event_t event;
+        if (!event_poll(&event, -1)) {
+            continue;
+        }
+        if (event.type == EVENT_QUIT) {
+            return;
+        }
+        if (event_count < MAX_EVENTS) {
+            events[event_count++] = event;
+        }
+    }
+}
+
+static bool is_mouse(int index, mouse_button_t button, mouse_action_t action, int x, int y) {
+    return index < event_count && events[index].type == EVENT_MOUSE &&
+           events[index].data.mouse.button == button &&
+           events[index].data.mouse.action == action &&
+           events[index].data.mouse.x == x && events[index].data.mouse.y == y;
+}
+
+static void test_motion(void) {
+    // A drag burst ends up at its last position
+    type(0, "\033[<0;1;1M\033[<32;2;1M\033[<32;3;1M\033[<32;6;2M\033[<0;6;2m");
+    read_events();
+    expect(event_count == 3 && is_mouse(0, MOUSE_LEFT, MOUSE_PRESS, 0, 0) &&
+           is_mouse(1, MOUSE_LEFT, MOUSE_DRAG, 5, 1) &&
+           is_mouse(2, MOUSE_LEFT, MOUSE_RELEASE, 5, 1),
+           "a drag burst isn't press, one drag, release");
+
+    // Hovering without a button folds the same way, but not into a drag
+    type(0, "\033[<35;1;1M\033[<35;4;3M\033[<32;4;3M\033[<32;5;3M");
+    read_events();
+    expect(event_count == 2 && is_mouse(0, 3, MOUSE_MOVE, 3, 2) &&
+           is_mouse(1, MOUSE_LEFT, MOUSE_DRAG, 4, 2),
+           "a hover burst followed by a drag isn't one move and one drag");
+
+    // Movements already handed out aren't changed by later ones
+    type(0, "\033[<35;1;1M");
+    type(50, "\033[<35;2;1M");
+    read_events();
+    expect(event_count == 2 && is_mouse(0, 3, MOUSE_MOVE, 0, 0) && is_mouse(1, 3, MOUSE_MOVE, 1, 0),
+           "movements arriving apart aren't kept apart");
+}
+
+static void test_wheel(void) {
+    // Steps over one spot are summed, in either direction
+    type(0, "\033[<65;3;2M\033[<65;3;2M\033[<64;3;2M\033[<65;3;2M");
+    read_events();
+    expect(event_count == 1 && is_mouse(0, MOUSE_SCROLL_DOWN, MOUSE_PRESS, 2, 1) &&
+           events[0].data.mouse.scroll_delta == 2,
+           "wheel steps over one spot aren't summed to 2 down");
+
+    type(0, "\033[<64;3;2M\033[<64;3;2M\033[<65;3;2M\033[<64;3;2M\033[<64;3;2M");
+    read_events();
+    expect(event_count == 1 && is_mouse(0, MOUSE_SCROLL_UP, MOUSE_PRESS, 2, 1) &&
+           events[0].data.mouse.scroll_delta == -3,
+           "wheel steps over one spot aren't summed to 3 up");
+
+    // Steps over different spots may reach different components
+    type(0, "\033[<65;3;2M\033[<65;3;3M");
+    read_events();
+    expect(event_count == 2 && events[0].data.mouse.scroll_delta == 1 &&
+           events[1].data.mouse.scroll_delta == 1,
+           "wheel steps over different spots are merged");
+
+    // A report split across reads is still one step
+    type(0, "\033[<6");
+    type(5, "5;3;2M");
+    read_events();
+    expect(event_count == 1 && is_mouse(0, MOUSE_SCROLL_DOWN, MOUSE_PRESS, 2, 1),
+           "a split wheel report isn't read as one step");
+}
+
+/* ========== Through the event loop ========== */
+
+static int scroll_offset = 0;
+static int selected = 0;
+
+static const char* list_item(int index, void* ctx) {
+    static char item[16];
+    (void)ctx;
+    snprintf(item, sizeof(item), "item %d", index);
+    return item;
+}
+
+static component_t* app(void) {
+    return List((ListConfig){
+        .item_provider = list_item,
+        .count = LIST_ITEMS,
+        .max_visible = 4,
+        .scroll_offset = &scroll_offset,
+        .selected_index = &selected,
+    });
+}
+
+static bool row_starts_with(int y, const char* text) {
+    for (int x = 0; text[x]; x++) {
+        tui_cell_t cell;
+        if (!tui_headless_get_cell(x, y, &cell) || cell.glyph[0] != text[x] || cell.glyph[1]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void test_wheel_scrolls_list(void) {
+    // List items are drawn after a two-column selection marker
+    type(10, "\033[<65;4;1M\033[<65;4;1M\033[<65;4;1M");
+    tui_init();
+    tui_set_root(app);
+    tui_run();
+    expect(scroll_offset == 3 && row_starts_with(0, "  item 3"),
+           "three wheel steps don't scroll the list to item 3");
+}
+
+int main(void) {
+    if (!tui_use_headless(20, 4) || !event_init()) {
+        fprintf(stderr, "mouse_test: can't set up the headless terminal\n");
+        return 1;
+    }
+
+    test_motion();
+    test_wheel();
+    event_cleanup();
+
+    test_wheel_scrolls_list();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,194 @@
+/**
+ * Rendering output: damage-limited repaint, scrolled regions, erased and
+ * repeated runs
+ *
+ * Each case renders two frames on the headless terminal, the second one
+ * after a key press, and checks the bytes sent for the second frame along
+ * with the cells it leaves on screen. The bytes are recorded by a backend
+ * that passes everything on to the headless one.
+ */
+
+#include "intuitive.h"
+#include "internal/backend.h"
+#include <stdio.h>
+#include <string.h>
+
+#define SCREEN_WIDTH 20
+#define SCREEN_HEIGHT 6
+
+#define OUTPUT_CAPACITY 65536
+
+static int failures = 0;
+
+static char output[OUTPUT_CAPACITY + 1];  // Room for a terminator
+static size_t output_length = 0;
+static size_t frame_start = 0;  // Where the output of the frame being built begins
+static int frame = 0;           // Frames built so far in the current case
+static component_t* (*case_root)(void) = NULL;
+
+static backend_t recording;
+
+static void expect(bool ok, const char* what) {
+    if (!ok) {
+        fprintf(stderr, "render_test: %s\n", what);
+        failures++;
+    }
+}
+
+static ssize_t recording_write(const char* data, size_t len) {
+    size_t space = OUTPUT_CAPACITY - output_length;
+    size_t kept = len < space ? len : space;
+    memcpy(output + output_length, data, kept);
+    output_length += kept;
+    return backend_headless.write(data, len);
+}
+
+static component_t* root(void) {
+    frame_start = output_length;
+    component_t* tree = case_root();
+    frame++;
+    return tree;
+}
+
+/**
+ * Render the first frame of build, then the second one, whose output is
+ * left in *bytes and *length
+ */
+static void run_case(component_t* (*build)(void), const char** bytes, size_t* length) {
+    tui_use_headless(SCREEN_WIDTH, SCREEN_HEIGHT);
+    recording = backend_headless;
+    recording.write = recording_write;
+    backend_set(&recording);
+
+    output_length = 0;
+    frame = 0;
+    case_root = build;
+    tui_headless_input(10, "n", 1);
+
+    tui_init();
+    tui_set_root(root);
+    tui_run();
+
+    tui_frame_stats_t stats;
+    *bytes = output + frame_start;
+    *length = 0;
+    if (frame == 2 && tui_get_frame_stats(&stats)) {
+        *length = stats.bytes;
+    }
+    output[frame_start + *length] = '\0';
+}
+
+static bool row_is(int y, const char* text) {
+    for (int x = 0; x < SCREEN_WIDTH; x++) {
+        tui_cell_t cell;
+        char expected = x < (int)strlen(text) ? text[x] : ' ';
+        if (!tui_headless_get_cell(x, y, &cell) || cell.glyph[0] != expected || cell.glyph[1]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* ========== Cases ========== */
+
+static component_t* build_counter(void) {
+    return VStack(Text("header", TEXT_DEFAULT),
+                  Text(frame == 0 ? "count 1" : "count 2", TEXT_DEFAULT),
+                  Text("footer", TEXT_DEFAULT),
+                  NULL);
+}
+
+static void test_damage(void) {
+    // Only the changed character is sent
+    const char* bytes;
+    size_t length;
+    run_case(build_counter, &bytes, &length);
+    expect(length > 0 && length <= 12 && strchr(bytes, '2') && !strstr(bytes, "header"),
+           "changing one character repaints more than that cell");
+    expect(row_is(0, "header") && row_is(1, "count 2") && row_is(2, "footer"),
+           "the counter frame isn't on screen");
+}
+
+static component_t* build_shrink(void) {
+    return VStack(Text("header", TEXT_DEFAULT),
+                  HStack(Text(frame == 0 ? "wide" : "w", TEXT_DEFAULT), Text("|", TEXT_DEFAULT), NULL),
+                  NULL);
+}
+
+static void test_damage_old_area(void) {
+    // What moved or shrank is cleared where it was drawn before
+    const char* bytes;
+    size_t length;
+    run_case(build_shrink, &bytes, &length);
+    expect(row_is(0, "header") && row_is(1, "w|"), "a shrunk text leaves its old cells behind");
+}
+
+// Log lines different enough that redrawing them costs more than a scroll
+static const char* const log_lines[SCREEN_HEIGHT] = {
+    "0 alpha bravo", "1 charlie delta", "2 echo foxtrot",
+    "3 golf hotel", "4 india juliett", "5 kilo lima",
+};
+
+static component_t* build_log(void) {
+    // A title over five lines that scroll up by one
+    component_t* children[SCREEN_HEIGHT + 1];
+    children[0] = Text("title", TEXT_DEFAULT);
+    for (int i = 0; i < SCREEN_HEIGHT - 1; i++) {
+        children[i + 1] = Text(log_lines[i + frame], TEXT_DEFAULT);
+    }
+    children[SCREEN_HEIGHT] = NULL;
+    return VStackArray(children);
+}
+
+static void test_scroll(void) {
+    // The lines below the title are scrolled, and only the new one drawn
+    const char* bytes;
+    size_t length;
+    run_case(build_log, &bytes, &length);
+    expect(strstr(bytes, "\033[2;6r\033[S\033[r") && strstr(bytes, log_lines[5]) &&
+           !strstr(bytes, "golf"),
+           "lines that moved up aren't scrolled in a region below the title");
+    expect(row_is(0, "title") && row_is(1, log_lines[1]) && row_is(4, log_lines[4]) &&
+           row_is(5, log_lines[5]),
+           "the scrolled frame isn't on screen");
+}
+
+static component_t* build_erase(void) {
+    return VStack(Text(frame == 0 ? "abcdefghijklmnop" : "ab", TEXT_DEFAULT),
+                  Text(frame == 0 ? "0123456789abcdef" : "0           cdef", TEXT_DEFAULT),
+                  NULL);
+}
+
+static void test_erase(void) {
+    // Blanks to the end of the row are erased with EL, inside it with ECH
+    const char* bytes;
+    size_t length;
+    run_case(build_erase, &bytes, &length);
+    expect(strstr(bytes, "\033[K") && strstr(bytes, "\033[11X") && !strstr(bytes, "    "),
+           "blank runs aren't erased with EL and ECH");
+    expect(row_is(0, "ab") && row_is(1, "0           cdef"), "the erased frame isn't on screen");
+}
+
+static component_t* build_rule(void) {
+    return VStack(Text("rule", TEXT_DEFAULT),
+                  Text(frame == 0 ? "" : "================", TEXT_DEFAULT),
+                  NULL);
+}
+
+static void test_repeat(void) {
+    // A run of one character is sent once and repeated with REP
+    const char* bytes;
+    size_t length;
+    run_case(build_rule, &bytes, &length);
+    expect(strstr(bytes, "=\033[15b") && !strstr(bytes, "=="), "a run of '=' isn't sent with REP");
+    expect(row_is(0, "rule") && row_is(1, "================"), "the repeated run isn't on screen");
+}
+
+int main(void) {
+    test_damage();
+    test_damage_old_area();
+    test_scroll();
+    test_erase();
+    test_repeat();
+    return failures == 0 ? 0 : 1;
+}
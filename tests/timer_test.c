@@ -0,0 +1,53 @@
+/**
+ * Timers added from a timer callback while the wheel is being swept
+ *
+ * A timeout re-arming itself with delay 0 must fire on a later tick even
+ * while another timer is pending; it used to land in the slot just swept,
+ * which made the event loop spin without letting time pass.
+ */
+
+#include "intuitive.h"
+#include <stdio.h>
+
+#define REARM_COUNT 5
+
+static int rearm_fired = 0;
+static int rearm_fired_at_end = -1;
+
+static component_t* app(void) {
+    return Text("timers", TEXT_DEFAULT);
+}
+
+static void rearm(void* ctx) {
+    (void)ctx;
+    if (++rearm_fired < REARM_COUNT) {
+        tui_set_timeout(0, rearm, NULL);
+    }
+}
+
+static void end(void* ctx) {
+    (void)ctx;
+    rearm_fired_at_end = rearm_fired;
+}
+
+int main(void) {
+    if (!tui_use_headless(20, 3)) {
+        fprintf(stderr, "timer_test: can't create the headless terminal\n");
+        return 1;
+    }
+    tui_init();
+    tui_set_root(app);
+
+    tui_set_timeout(10, rearm, NULL);
+    tui_set_timeout(2000, end, NULL);
+
+    // Returns once both chains are done and nothing is left to wait for
+    tui_run();
+
+    if (rearm_fired_at_end != REARM_COUNT) {
+        fprintf(stderr, "timer_test: %d of %d re-armed timeouts fired before the 2 s one\n",
+                rearm_fired_at_end, REARM_COUNT);
+        return 1;
+    }
+    return 0;
+}